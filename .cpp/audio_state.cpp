@@ -0,0 +1,140 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cstring>
+#include "audio_state.h"
+
+// Bits of the per-event flag byte.
+static const unsigned char flag_3d = 1;
+static const unsigned char flag_paused = 2;
+static const unsigned char flag_emitter = 4;
+
+void AudioStateCodec::writeVarint(std::vector<unsigned char>& blob, unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		blob.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	blob.push_back((unsigned char)value);
+}
+
+void AudioStateCodec::writeRaw(std::vector<unsigned char>& blob, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	blob.insert(blob.end(), bytes, bytes + size);
+}
+
+bool AudioStateCodec::readVarint(const std::vector<unsigned char>& blob, size_t& position, unsigned long long& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (position >= blob.size()) { return false; }
+		unsigned char byte = blob[position++];
+		value |= (unsigned long long)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) { return true; }
+	}
+	return false;
+}
+
+bool AudioStateCodec::readRaw(const std::vector<unsigned char>& blob, size_t& position, void* data, size_t size)
+{
+	if (blob.size() - position < size) { return false; }
+	std::memcpy(data, blob.data() + position, size);
+	position += size;
+	return true;
+}
+
+void AudioStateCodec::encode(const SavedAudioState& state, std::vector<unsigned char>& blob)
+{
+	blob.clear();
+	writeVarint(blob, blob_magic);
+	writeVarint(blob, blob_version);
+
+	writeVarint(blob, state.events.size());
+	for (size_t i = 0; i < state.events.size(); i++)
+	{
+		const SavedEventState& event = state.events[i];
+
+		unsigned char flags = 0;
+		if (event.is_3d) { flags |= flag_3d; }
+		if (event.paused) { flags |= flag_paused; }
+		if (event.emitter) { flags |= flag_emitter; }
+
+		writeVarint(blob, event.id);
+		writeRaw(blob, &event.guid, sizeof(FMOD_GUID));
+		writeVarint(blob, event.timeline_position < 0 ? 0 : (unsigned long long)event.timeline_position);
+		blob.push_back(flags);
+		if (event.is_3d) { writeRaw(blob, &event.attributes, sizeof(FMOD_3D_ATTRIBUTES)); }
+
+		writeVarint(blob, event.parameters.size());
+		for (size_t p = 0; p < event.parameters.size(); p++)
+		{
+			writeRaw(blob, &event.parameters[p].id, sizeof(FMOD_STUDIO_PARAMETER_ID));
+			writeRaw(blob, &event.parameters[p].value, sizeof(float));
+		}
+	}
+
+	writeVarint(blob, state.paused_buses.size());
+	for (size_t i = 0; i < state.paused_buses.size(); i++)
+	{
+		writeVarint(blob, state.paused_buses[i].size());
+		writeRaw(blob, state.paused_buses[i].data(), state.paused_buses[i].size());
+	}
+}
+
+int AudioStateCodec::decode(const std::vector<unsigned char>& blob, SavedAudioState& state)
+{
+	state.events.clear();
+	state.paused_buses.clear();
+
+	size_t position = 0;
+	unsigned long long value = 0;
+
+	if (!readVarint(blob, position, value) || value != blob_magic) { return 0; }
+	if (!readVarint(blob, position, value) || value != blob_version) { return 0; }
+
+	unsigned long long event_count = 0;
+	if (!readVarint(blob, position, event_count)) { return 0; }
+
+	for (unsigned long long i = 0; i < event_count; i++)
+	{
+		SavedEventState event;
+		unsigned char flags = 0;
+
+		if (!readVarint(blob, position, value)) { return 0; }
+		event.id = (unsigned long int)value;
+		if (!readRaw(blob, position, &event.guid, sizeof(FMOD_GUID))) { return 0; }
+		if (!readVarint(blob, position, value)) { return 0; }
+		event.timeline_position = (int)value;
+		if (!readRaw(blob, position, &flags, 1)) { return 0; }
+
+		event.is_3d = (flags & flag_3d) != 0;
+		event.paused = (flags & flag_paused) != 0;
+		event.emitter = (flags & flag_emitter) != 0;
+		if (event.is_3d && !readRaw(blob, position, &event.attributes, sizeof(FMOD_3D_ATTRIBUTES))) { return 0; }
+
+		unsigned long long parameter_count = 0;
+		if (!readVarint(blob, position, parameter_count)) { return 0; }
+		for (unsigned long long p = 0; p < parameter_count; p++)
+		{
+			SavedParameter parameter;
+			if (!readRaw(blob, position, &parameter.id, sizeof(FMOD_STUDIO_PARAMETER_ID))) { return 0; }
+			if (!readRaw(blob, position, &parameter.value, sizeof(float))) { return 0; }
+			event.parameters.push_back(parameter);
+		}
+		state.events.push_back(event);
+	}
+
+	unsigned long long bus_count = 0;
+	if (!readVarint(blob, position, bus_count)) { return 0; }
+	for (unsigned long long i = 0; i < bus_count; i++)
+	{
+		unsigned long long length = 0;
+		if (!readVarint(blob, position, length) || blob.size() - position < length) { return 0; }
+		state.paused_buses.push_back(std::string((const char*)blob.data() + position, (size_t)length));
+		position += (size_t)length;
+	}
+	return 1;
+}
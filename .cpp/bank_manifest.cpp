@@ -0,0 +1,80 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "bank_manifest.h"
+
+std::string BankManifest::guidToString(const FMOD_GUID& guid)
+{
+	char buffer[40];
+	std::snprintf(buffer, sizeof(buffer), "{%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x}",
+				  guid.Data1, guid.Data2, guid.Data3,
+				  guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3],
+				  guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7]);
+	return buffer;
+}
+
+int BankManifest::addBank(const std::string& bank_file, FMOD::Studio::Bank* bank)
+{
+	int count = 0;
+	if (bank->getEventCount(&count) != FMOD_OK || count <= 0) { return 0; }
+
+	std::vector<FMOD::Studio::EventDescription*> events(count);
+	if (bank->getEventList(events.data(), count, &count) != FMOD_OK) { return 0; }
+
+	char path[512];
+	int retrieved = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		FMOD_GUID guid;
+		if (events[i]->getID(&guid) == FMOD_OK)
+		{
+			m_event_to_bank[guidToString(guid)] = bank_file;
+		}
+
+		// Paths are only available while the strings bank is loaded, the GUID entry is enough to find the bank otherwise.
+		if (events[i]->getPath(path, sizeof(path), &retrieved) == FMOD_OK)
+		{
+			m_event_to_bank[path] = bank_file;
+		}
+	}
+	return count;
+}
+
+const std::string* BankManifest::findBank(const std::string& event) const
+{
+	auto find_key = m_event_to_bank.find(event);
+	if (find_key == m_event_to_bank.end()) { return nullptr; }
+	return &find_key->second;
+}
+
+int BankManifest::save(const std::string& file_path) const
+{
+	std::ofstream file(file_path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open()) { return 0; }
+
+	// One "<event path or GUID>\t<bank file>" pair per line.
+	for (auto it = m_event_to_bank.begin(); it != m_event_to_bank.end(); it++)
+	{
+		file << it->first << '\t' << it->second << '\n';
+	}
+	return file.good() ? 1 : 0;
+}
+
+int BankManifest::load(const std::string& file_path)
+{
+	std::ifstream file(file_path.c_str(), std::ios::in);
+	if (!file.is_open()) { return 0; }
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t separator = line.find('\t');
+		if (separator == std::string::npos) { continue; }
+		m_event_to_bank[line.substr(0, separator)] = line.substr(separator + 1);
+	}
+	return 1;
+}
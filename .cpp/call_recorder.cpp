@@ -0,0 +1,1053 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cstring>
+#include <thread>
+#include "call_recorder.h"
+#include "fmod_wrapper.h"
+
+CallRecorder::CallRecorder()
+{
+	m_frame = 0;
+	m_buffer.reserve(64 * 1024);
+}
+
+CallRecorder::~CallRecorder()
+{
+	close();
+}
+
+int CallRecorder::open(const std::string& file_path)
+{
+	close();
+
+	m_file.open(file_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open()) { return 0; }
+
+	m_frame = 0;
+	m_strings.clear();
+	m_buffer.clear();
+	m_start_time = std::chrono::steady_clock::now();
+
+	writeVarint(file_magic);
+	writeVarint(file_version);
+	return 1;
+}
+
+void CallRecorder::close()
+{
+	if (!m_file.is_open()) { return; }
+	flushBuffer();
+	m_file.close();
+}
+
+void CallRecorder::writeByte(unsigned char value)
+{
+	m_buffer.push_back(value);
+}
+
+void CallRecorder::writeVarint(unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		m_buffer.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	m_buffer.push_back((unsigned char)value);
+}
+
+void CallRecorder::writeFloat(float value)
+{
+	unsigned char bytes[sizeof(float)];
+	std::memcpy(bytes, &value, sizeof(float));
+	m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(float));
+}
+
+void CallRecorder::writeVector(const FMOD_VECTOR& vector)
+{
+	writeFloat(vector.x);
+	writeFloat(vector.y);
+	writeFloat(vector.z);
+}
+
+void CallRecorder::writeAttributes(const FMOD_3D_ATTRIBUTES& attributes)
+{
+	writeVector(attributes.position);
+	writeVector(attributes.velocity);
+	writeVector(attributes.forward);
+	writeVector(attributes.up);
+}
+
+void CallRecorder::writeParameters(const std::map<std::string, float>& parameters)
+{
+	writeVarint(parameters.size());
+	for (auto it = parameters.begin(); it != parameters.end(); it++)
+	{
+		writeStringRef(it->first);
+		writeFloat(it->second);
+	}
+}
+
+void CallRecorder::writeStringRef(const std::string& value)
+{
+	writeVarint(m_strings[value]);
+}
+
+void CallRecorder::internString(const std::string& value)
+{
+	if (m_strings.find(value) != m_strings.end()) { return; }
+
+	unsigned long int index = (unsigned long int)m_strings.size();
+	m_strings[value] = index;
+
+	writeByte(op_string);
+	writeVarint(value.size());
+	m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+}
+
+void CallRecorder::internParameters(const std::map<std::string, float>& parameters)
+{
+	for (auto it = parameters.begin(); it != parameters.end(); it++)
+	{
+		internString(it->first);
+	}
+}
+
+void CallRecorder::flushBuffer()
+{
+	if (m_buffer.empty() || !m_file.is_open()) { return; }
+	m_file.write((const char*)m_buffer.data(), m_buffer.size());
+	m_buffer.clear();
+}
+
+void CallRecorder::recordUpdate()
+{
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start_time);
+
+	writeByte(op_update);
+	writeVarint((unsigned long long)elapsed.count());
+	m_frame++;
+
+	// Only touch the disk between frames, and only once the buffer has grown large enough to be worth it.
+	if (m_buffer.size() >= 60 * 1024) { flushBuffer(); }
+}
+
+void CallRecorder::recordBankOp(CaptureOp op, const std::string& bank, bool load_samples)
+{
+	internString(bank);
+	writeByte(op);
+	writeStringRef(bank);
+	if (op == op_load_bank) { writeByte(load_samples ? 1 : 0); }
+}
+
+void CallRecorder::recordReloadBank(const std::string& bank, float drain_timeout)
+{
+	internString(bank);
+	writeByte(op_reload_bank);
+	writeStringRef(bank);
+	writeFloat(drain_timeout);
+}
+
+void CallRecorder::recordSetVoiceoverLocale(const std::string& locale, const std::string& bank)
+{
+	// The bank is recorded too, so that the replay can register the locale.
+	internString(locale);
+	internString(bank);
+	writeByte(op_set_voiceover_locale);
+	writeStringRef(locale);
+	writeStringRef(bank);
+}
+
+void CallRecorder::recordSetLazyBankLoading(bool enabled, float timeout_seconds)
+{
+	writeByte(op_set_lazy_bank_loading);
+	writeByte(enabled ? 1 : 0);
+	writeFloat(timeout_seconds);
+}
+
+void CallRecorder::recordPlay3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_play_3d);
+	writeVarint(id);
+	writeStringRef(event);
+	writeAttributes(spatial_attributes);
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordPlay2D(const std::string& event, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_play_2d);
+	writeVarint(id);
+	writeStringRef(event);
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordPlayOneShot3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_play_one_shot_3d);
+	writeStringRef(event);
+	writeAttributes(spatial_attributes);
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordPlayOneShot2D(const std::string& event, const std::map<std::string, float>& parameters)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_play_one_shot_2d);
+	writeStringRef(event);
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordSchedulePlayAfterEvent(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_schedule_play_after_event);
+	writeVarint(id);
+	writeStringRef(event);
+	writeVarint((unsigned long int)reference_event_id);
+	writeFloat((float)offset_seconds);
+	// 2D plays are scheduled without attributes.
+	writeByte(spatial_attributes != nullptr ? 1 : 0);
+	if (spatial_attributes != nullptr) { writeAttributes(*spatial_attributes); }
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordSchedulePlayOnBeat(const std::string& event, int reference_event_id, bool on_bar, int extra, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(event);
+	internParameters(parameters);
+	writeByte(op_schedule_play_on_beat);
+	writeVarint(id);
+	writeStringRef(event);
+	writeVarint((unsigned long int)reference_event_id);
+	writeByte(on_bar ? 1 : 0);
+	writeVarint((unsigned long int)extra);
+	writeByte(spatial_attributes != nullptr ? 1 : 0);
+	if (spatial_attributes != nullptr) { writeAttributes(*spatial_attributes); }
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordStop(int event_id, bool allow_fades)
+{
+	writeByte(op_stop);
+	writeVarint((unsigned long int)event_id);
+	writeByte(allow_fades ? 1 : 0);
+}
+
+void CallRecorder::recordSet3DAttributes(int event_id, const FMOD_3D_ATTRIBUTES& spatial_attributes)
+{
+	writeByte(op_set_3d_attributes);
+	writeVarint((unsigned long int)event_id);
+	writeAttributes(spatial_attributes);
+}
+
+void CallRecorder::recordEmitterOp(CaptureOp op, int event_id)
+{
+	writeByte(op);
+	writeVarint((unsigned long int)event_id);
+}
+
+void CallRecorder::recordRegisterEmitter(int event_id, float cluster_weight)
+{
+	writeByte(op_register_emitter_weighted);
+	writeVarint((unsigned long int)event_id);
+	writeFloat(cluster_weight);
+}
+
+void CallRecorder::recordEnableEmitterClustering(const std::string& event, const EmitterClusterSettings& settings)
+{
+	internString(event);
+	internString(settings.density_parameter);
+	writeByte(op_enable_emitter_clustering);
+	writeStringRef(event);
+	writeFloat(settings.join_radius);
+	writeFloat(settings.leave_radius);
+	writeFloat(settings.merge_distance);
+	writeStringRef(settings.density_parameter);
+	writeFloat(settings.movement_threshold);
+}
+
+void CallRecorder::recordDisableEmitterClustering(const std::string& event)
+{
+	internString(event);
+	writeByte(op_disable_emitter_clustering);
+	writeStringRef(event);
+}
+
+void CallRecorder::recordSetEmitterLodSettings(const EmitterLodSettings& settings)
+{
+	writeByte(op_set_emitter_lod_settings_interpolated);
+	writeFloat(settings.cell_size);
+	writeFloat(settings.near_distance);
+	writeFloat(settings.mid_distance);
+	writeVarint((unsigned long int)settings.mid_interval);
+	writeVarint((unsigned long int)settings.far_interval);
+	writeFloat(settings.movement_threshold);
+	writeByte(settings.interpolate ? 1 : 0);
+}
+
+void CallRecorder::recordEnableOcclusion(int event_id, const std::string& parameter)
+{
+	internString(parameter);
+	writeByte(op_enable_occlusion);
+	writeVarint((unsigned long int)event_id);
+	writeStringRef(parameter);
+}
+
+void CallRecorder::recordSetOcclusionSettings(const OcclusionSettings& settings)
+{
+	writeByte(op_set_occlusion_settings);
+	writeVarint((unsigned long int)settings.max_rays_per_update);
+	writeFloat(settings.max_distance);
+	writeFloat(settings.min_interval_seconds);
+	writeFloat(settings.smoothing_seconds);
+	writeFloat(settings.lowpass_min_gain);
+}
+
+void CallRecorder::recordAddStreamingZone(const StreamingZone& zone, unsigned long int id)
+{
+	for (size_t i = 0; i < zone.banks.size(); i++)
+	{
+		internString(zone.banks[i]);
+	}
+
+	writeByte(op_add_streaming_zone);
+	writeVarint(id);
+	writeByte(zone.is_sphere ? 1 : 0);
+	writeVector(zone.center);
+	writeFloat(zone.radius);
+	writeVector(zone.half_extents);
+	writeFloat(zone.prefetch_distance);
+	writeFloat(zone.release_distance);
+	writeVarint(zone.banks.size());
+	for (size_t i = 0; i < zone.banks.size(); i++)
+	{
+		writeStringRef(zone.banks[i]);
+	}
+}
+
+void CallRecorder::recordAddBusMeter(const std::string& bus, unsigned long int id)
+{
+	internString(bus);
+	writeByte(op_add_bus_meter);
+	writeVarint(id);
+	writeStringRef(bus);
+}
+
+void CallRecorder::recordSetMeterSmoothing(float attack_seconds, float release_seconds)
+{
+	writeByte(op_set_meter_smoothing);
+	writeFloat(attack_seconds);
+	writeFloat(release_seconds);
+}
+
+void CallRecorder::recordRestoreAudioState(const std::vector<unsigned char>& blob, int instances_per_update, bool stop_current, float bank_timeout, const std::vector<std::pair<unsigned long int, unsigned long int>>& id_map)
+{
+	writeByte(op_restore_audio_state);
+	writeVarint(instances_per_update < 0 ? 0 : instances_per_update);
+	writeByte(stop_current ? 1 : 0);
+	writeFloat(bank_timeout);
+	writeVarint(blob.size());
+	m_buffer.insert(m_buffer.end(), blob.begin(), blob.end());
+	writeVarint(id_map.size());
+	for (size_t i = 0; i < id_map.size(); i++)
+	{
+		writeVarint(id_map[i].first);
+		writeVarint(id_map[i].second);
+	}
+}
+
+void CallRecorder::recordIdOp(CaptureOp op, unsigned long int id)
+{
+	writeByte(op);
+	writeVarint(id);
+}
+
+void CallRecorder::recordSetListenerAttributes(int listener_index, const FMOD_3D_ATTRIBUTES& spatial_attributes)
+{
+	writeByte(op_set_listener_attributes);
+	writeVarint((unsigned long int)listener_index);
+	writeAttributes(spatial_attributes);
+}
+
+void CallRecorder::recordSetNumberOfListeners(int num_listeners)
+{
+	writeByte(op_set_number_of_listeners);
+	writeVarint((unsigned long int)num_listeners);
+}
+
+void CallRecorder::recordSetListenerWeight(int listener_index, float weight)
+{
+	writeByte(op_set_listener_weight);
+	writeVarint((unsigned long int)listener_index);
+	writeFloat(weight);
+}
+
+void CallRecorder::recordSetParameter(int event_id, const std::string& parameter, float value)
+{
+	internString(parameter);
+	writeByte(op_set_parameter);
+	writeVarint((unsigned long int)event_id);
+	writeStringRef(parameter);
+	writeFloat(value);
+}
+
+void CallRecorder::recordSetGlobalParameter(const std::string& parameter, float value)
+{
+	internString(parameter);
+	writeByte(op_set_global_parameter);
+	writeStringRef(parameter);
+	writeFloat(value);
+}
+
+void CallRecorder::recordSetUpdateCoalescing(bool enabled, float parameter_epsilon, float movement_threshold)
+{
+	writeByte(op_set_update_coalescing);
+	writeByte(enabled ? 1 : 0);
+	writeFloat(parameter_epsilon);
+	writeFloat(movement_threshold);
+}
+
+void CallRecorder::recordBusOp(CaptureOp op, const std::string& bus, bool flag)
+{
+	internString(bus);
+	writeByte(op);
+	writeStringRef(bus);
+	writeByte(flag ? 1 : 0);
+}
+
+void CallRecorder::recordMixerVolume(CaptureOp op, const std::string& path, float volume, float fade_seconds)
+{
+	internString(path);
+	writeByte(op);
+	writeStringRef(path);
+	writeFloat(volume);
+	writeFloat(fade_seconds);
+}
+
+void CallRecorder::recordActivateSnapshot(const std::string& snapshot, float intensity, int priority, float ramp_seconds, unsigned long int id)
+{
+	internString(snapshot);
+	writeByte(op_activate_snapshot);
+	writeVarint(id);
+	writeStringRef(snapshot);
+	writeFloat(intensity);
+	// Zigzag encoded, priorities may be negative.
+	writeVarint(((unsigned long long)priority << 1) ^ (unsigned long long)(long long)(priority >> 31));
+	writeFloat(ramp_seconds);
+}
+
+void CallRecorder::recordSnapshotIntensity(unsigned long int request_id, float intensity, float ramp_seconds)
+{
+	writeByte(op_set_snapshot_intensity);
+	writeVarint(request_id);
+	writeFloat(intensity);
+	writeFloat(ramp_seconds);
+}
+
+void CallRecorder::recordReleaseSnapshot(unsigned long int request_id, float ramp_seconds)
+{
+	writeByte(op_release_snapshot);
+	writeVarint(request_id);
+	writeFloat(ramp_seconds);
+}
+
+void CallRecorder::recordPlayDialogue3D(const std::string& key, int master_event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(key);
+	internParameters(parameters);
+	writeByte(op_play_dialogue_3d);
+	writeVarint(id);
+	writeStringRef(key);
+	writeVarint((unsigned long int)master_event);
+	writeAttributes(spatial_attributes);
+	writeParameters(parameters);
+}
+
+void CallRecorder::recordPlayDialogue2D(const std::string& key, int master_event, const std::map<std::string, float>& parameters, unsigned long int id)
+{
+	internString(key);
+	internParameters(parameters);
+	writeByte(op_play_dialogue_2d);
+	writeVarint(id);
+	writeStringRef(key);
+	writeVarint((unsigned long int)master_event);
+	writeParameters(parameters);
+}
+
+
+unsigned char CallReplayer::readByte()
+{
+	if (m_position >= m_data.size())
+	{
+		m_read_error = true;
+		return 0;
+	}
+	return m_data[m_position++];
+}
+
+unsigned long long CallReplayer::readVarint()
+{
+	unsigned long long value = 0;
+	int shift = 0;
+
+	while (!m_read_error && shift < 64)
+	{
+		unsigned char byte = readByte();
+		value |= (unsigned long long)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) { break; }
+		shift += 7;
+	}
+	return value;
+}
+
+float CallReplayer::readFloat()
+{
+	float value = 0.0f;
+	if (m_position + sizeof(float) > m_data.size())
+	{
+		m_read_error = true;
+		return value;
+	}
+	std::memcpy(&value, &m_data[m_position], sizeof(float));
+	m_position += sizeof(float);
+	return value;
+}
+
+FMOD_VECTOR CallReplayer::readVector()
+{
+	FMOD_VECTOR vector;
+	vector.x = readFloat();
+	vector.y = readFloat();
+	vector.z = readFloat();
+	return vector;
+}
+
+FMOD_3D_ATTRIBUTES CallReplayer::readAttributes()
+{
+	FMOD_3D_ATTRIBUTES attributes;
+	attributes.position = readVector();
+	attributes.velocity = readVector();
+	attributes.forward = readVector();
+	attributes.up = readVector();
+	return attributes;
+}
+
+std::map<std::string, float> CallReplayer::readParameters()
+{
+	std::map<std::string, float> parameters;
+	unsigned long long count = readVarint();
+	for (unsigned long long i = 0; i < count && !m_read_error; i++)
+	{
+		const std::string& name = readStringRef();
+		parameters[name] = readFloat();
+	}
+	return parameters;
+}
+
+const std::string& CallReplayer::readStringRef()
+{
+	static const std::string invalid_string;
+
+	unsigned long long index = readVarint();
+	if (index >= m_strings.size())
+	{
+		m_read_error = true;
+		return invalid_string;
+	}
+	return m_strings[(size_t)index];
+}
+
+int CallReplayer::mapId(unsigned long long recorded_id)
+{
+	auto find_key = m_id_map.find((unsigned long int)recorded_id);
+	if (find_key == m_id_map.end()) { return 0; }
+	return (int)find_key->second;
+}
+
+void CallReplayer::addIdMapping(unsigned long long recorded_id, unsigned long int id)
+{
+	// Failed calls were recorded with ID 0, which must keep mapping to nothing.
+	if (recorded_id == 0 || id == 0) { return; }
+	m_id_map[(unsigned long int)recorded_id] = id;
+}
+
+int CallReplayer::replay(const std::string& file_path, FmodWrapper& wrapper, ReplayMode mode, ReplayStats* stats)
+{
+	std::ifstream file(file_path.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open()) { return 0; }
+
+	m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	m_position = 0;
+	m_read_error = false;
+	m_strings.clear();
+	m_id_map.clear();
+
+	if (readVarint() != CallRecorder::file_magic || readVarint() != CallRecorder::file_version)
+	{
+		// Not a capture log, or one written by an incompatible version of the wrapper.
+		return 0;
+	}
+
+	ReplayStats local_stats;
+	auto replay_start = std::chrono::steady_clock::now();
+
+	while (m_position < m_data.size() && !m_read_error)
+	{
+		CallRecorder::CaptureOp op = (CallRecorder::CaptureOp)readByte();
+
+		switch (op)
+		{
+			case CallRecorder::op_string:
+			{
+				size_t length = (size_t)readVarint();
+				if (m_position + length > m_data.size())
+				{
+					m_read_error = true;
+					break;
+				}
+				m_strings.push_back(std::string((const char*)&m_data[m_position], length));
+				m_position += length;
+				continue;
+			}
+			case CallRecorder::op_update:
+			{
+				unsigned long long timestamp_us = readVarint();
+
+				if (mode == real_time)
+				{
+					std::this_thread::sleep_until(replay_start + std::chrono::microseconds(timestamp_us));
+				}
+
+				auto update_start = std::chrono::steady_clock::now();
+				FmodWrapper::callUpdate();
+				double update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - update_start).count();
+
+				local_stats.total_update_ms += update_ms;
+				if (update_ms > local_stats.worst_update_ms)
+				{
+					local_stats.worst_update_ms = update_ms;
+					local_stats.worst_update_frame = local_stats.frames;
+				}
+				local_stats.frames++;
+				continue;
+			}
+			case CallRecorder::op_load_bank:
+			{
+				std::string bank = readStringRef();
+				bool load_samples = readByte() != 0;
+				wrapper.loadBank(bank, load_samples);
+				break;
+			}
+			case CallRecorder::op_unload_bank:
+				wrapper.unloadBank(readStringRef());
+				break;
+			case CallRecorder::op_load_sample_data:
+				wrapper.loadSampleData(readStringRef());
+				break;
+			case CallRecorder::op_unload_sample_data:
+				wrapper.unloadSampleData(readStringRef());
+				break;
+			case CallRecorder::op_play_3d:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string event = readStringRef();
+				FMOD_3D_ATTRIBUTES attributes = readAttributes();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.play3DEvent(event, attributes, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_play_2d:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string event = readStringRef();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.play2DEvent(event, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_stop:
+			{
+				int id = mapId(readVarint());
+				bool allow_fades = readByte() != 0;
+				wrapper.stopEvent(id, allow_fades);
+				break;
+			}
+			case CallRecorder::op_set_3d_attributes:
+			{
+				int id = mapId(readVarint());
+				FMOD_3D_ATTRIBUTES attributes = readAttributes();
+				if (m_read_error) { break; }
+				wrapper.set3DAttributes(id, attributes);
+				break;
+			}
+			case CallRecorder::op_set_listener_attributes:
+			{
+				int listener_index = (int)readVarint();
+				FMOD_3D_ATTRIBUTES attributes = readAttributes();
+				if (m_read_error) { break; }
+				FmodWrapper::setListenerAttributes(listener_index, attributes);
+				break;
+			}
+			case CallRecorder::op_set_parameter:
+			{
+				int id = mapId(readVarint());
+				std::string parameter = readStringRef();
+				float value = readFloat();
+				if (m_read_error) { break; }
+				wrapper.setParameterByName(id, parameter, value);
+				break;
+			}
+			case CallRecorder::op_set_global_parameter:
+			{
+				std::string parameter = readStringRef();
+				float value = readFloat();
+				if (m_read_error) { break; }
+				wrapper.setGlobalParameterByName(parameter, value);
+				break;
+			}
+			case CallRecorder::op_set_bus_paused:
+			{
+				std::string bus = readStringRef();
+				bool is_paused = readByte() != 0;
+				wrapper.setBusPauseStatus(bus, is_paused);
+				break;
+			}
+			case CallRecorder::op_stop_bus_events:
+			{
+				std::string bus = readStringRef();
+				bool allow_fades = readByte() != 0;
+				wrapper.stopAllBusEvents(bus, allow_fades);
+				break;
+			}
+			case CallRecorder::op_play_dialogue_3d:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string key = readStringRef();
+				FmodWrapper::DialogueMasterEvents master_event = (FmodWrapper::DialogueMasterEvents)readVarint();
+				FMOD_3D_ATTRIBUTES attributes = readAttributes();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.playDialogue3D(key, master_event, attributes, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_play_dialogue_2d:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string key = readStringRef();
+				FmodWrapper::DialogueMasterEvents master_event = (FmodWrapper::DialogueMasterEvents)readVarint();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.playDialogue2D(key, master_event, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_play_one_shot_3d:
+			{
+				std::string event = readStringRef();
+				FMOD_3D_ATTRIBUTES attributes = readAttributes();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				wrapper.playOneShot3D(event, attributes, parameters);
+				break;
+			}
+			case CallRecorder::op_play_one_shot_2d:
+			{
+				std::string event = readStringRef();
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				wrapper.playOneShot2D(event, parameters);
+				break;
+			}
+			case CallRecorder::op_schedule_play_after_event:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string event = readStringRef();
+				int reference_id = mapId(readVarint());
+				float offset_seconds = readFloat();
+				bool is_3d = readByte() != 0;
+				FMOD_3D_ATTRIBUTES attributes = {};
+				if (is_3d) { attributes = readAttributes(); }
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.schedulePlayAfterEvent(event, reference_id, offset_seconds, is_3d ? &attributes : nullptr, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_schedule_play_on_beat:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string event = readStringRef();
+				int reference_id = mapId(readVarint());
+				bool on_bar = readByte() != 0;
+				int extra = (int)readVarint();
+				bool is_3d = readByte() != 0;
+				FMOD_3D_ATTRIBUTES attributes = {};
+				if (is_3d) { attributes = readAttributes(); }
+				std::map<std::string, float> parameters = readParameters();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.schedulePlayOnBeat(event, reference_id, on_bar, extra, is_3d ? &attributes : nullptr, parameters);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_register_emitter:
+				// Logs written before the cluster weight was recorded.
+				wrapper.registerEmitter(mapId(readVarint()));
+				break;
+			case CallRecorder::op_register_emitter_weighted:
+			{
+				int event_id = mapId(readVarint());
+				float cluster_weight = readFloat();
+				if (m_read_error) { break; }
+				wrapper.registerEmitter(event_id, cluster_weight);
+				break;
+			}
+			case CallRecorder::op_enable_emitter_clustering:
+			{
+				std::string event = readStringRef();
+				EmitterClusterSettings settings;
+				settings.join_radius = readFloat();
+				settings.leave_radius = readFloat();
+				settings.merge_distance = readFloat();
+				settings.density_parameter = readStringRef();
+				settings.movement_threshold = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::enableEmitterClustering(event, settings);
+				break;
+			}
+			case CallRecorder::op_disable_emitter_clustering:
+			{
+				std::string event = readStringRef();
+				if (m_read_error) { break; }
+				FmodWrapper::disableEmitterClustering(event);
+				break;
+			}
+			case CallRecorder::op_unregister_emitter:
+				wrapper.unregisterEmitter(mapId(readVarint()));
+				break;
+			case CallRecorder::op_set_number_of_listeners:
+				FmodWrapper::setNumberOfListeners((int)readVarint());
+				break;
+			case CallRecorder::op_set_listener_weight:
+			{
+				int listener_index = (int)readVarint();
+				float weight = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::setListenerWeight(listener_index, weight);
+				break;
+			}
+			case CallRecorder::op_set_bus_volume:
+			case CallRecorder::op_set_vca_volume:
+			{
+				std::string path = readStringRef();
+				float volume = readFloat();
+				float fade_seconds = readFloat();
+				if (m_read_error) { break; }
+				if (op == CallRecorder::op_set_bus_volume) { wrapper.setBusVolume(path, volume, fade_seconds); }
+				else { wrapper.setVCAVolume(path, volume, fade_seconds); }
+				break;
+			}
+			case CallRecorder::op_activate_snapshot:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string snapshot = readStringRef();
+				float intensity = readFloat();
+				unsigned long long zigzag = readVarint();
+				int priority = (int)((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+				float ramp_seconds = readFloat();
+				if (m_read_error) { break; }
+				unsigned long int id = wrapper.activateSnapshot(snapshot, intensity, priority, ramp_seconds);
+				addIdMapping(recorded_id, id);
+				break;
+			}
+			case CallRecorder::op_set_snapshot_intensity:
+			{
+				int id = mapId(readVarint());
+				float intensity = readFloat();
+				float ramp_seconds = readFloat();
+				if (m_read_error) { break; }
+				wrapper.setSnapshotIntensity(id, intensity, ramp_seconds);
+				break;
+			}
+			case CallRecorder::op_release_snapshot:
+			{
+				int id = mapId(readVarint());
+				float ramp_seconds = readFloat();
+				if (m_read_error) { break; }
+				wrapper.releaseSnapshot(id, ramp_seconds);
+				break;
+			}
+			case CallRecorder::op_reload_bank:
+			{
+				std::string bank = readStringRef();
+				float drain_timeout = readFloat();
+				if (m_read_error) { break; }
+				wrapper.reloadBank(bank, drain_timeout);
+				break;
+			}
+			case CallRecorder::op_set_voiceover_locale:
+			{
+				std::string locale = readStringRef();
+				std::string bank = readStringRef();
+				if (m_read_error) { break; }
+				FmodWrapper::addVoiceoverLocale(locale, bank);
+				wrapper.setVoiceoverLocale(locale);
+				break;
+			}
+			case CallRecorder::op_set_lazy_bank_loading:
+			{
+				bool enabled = readByte() != 0;
+				float timeout_seconds = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::setLazyBankLoading(enabled, timeout_seconds);
+				break;
+			}
+			case CallRecorder::op_load_bank_manifest:
+				FmodWrapper::loadBankManifest(readStringRef());
+				break;
+			case CallRecorder::op_set_update_coalescing:
+			{
+				bool enabled = readByte() != 0;
+				float parameter_epsilon = readFloat();
+				float movement_threshold = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::setUpdateCoalescing(enabled, parameter_epsilon, movement_threshold);
+				break;
+			}
+			case CallRecorder::op_enable_occlusion:
+			{
+				int id = mapId(readVarint());
+				std::string parameter = readStringRef();
+				if (m_read_error) { break; }
+				wrapper.enableOcclusion(id, parameter);
+				break;
+			}
+			case CallRecorder::op_disable_occlusion:
+				wrapper.disableOcclusion(mapId(readVarint()));
+				break;
+			case CallRecorder::op_set_occlusion_settings:
+			{
+				OcclusionSettings settings;
+				settings.max_rays_per_update = (int)readVarint();
+				settings.max_distance = readFloat();
+				settings.min_interval_seconds = readFloat();
+				settings.smoothing_seconds = readFloat();
+				settings.lowpass_min_gain = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::setOcclusionSettings(settings);
+				break;
+			}
+			case CallRecorder::op_add_streaming_zone:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				StreamingZone zone;
+				zone.is_sphere = readByte() != 0;
+				zone.center = readVector();
+				zone.radius = readFloat();
+				zone.half_extents = readVector();
+				zone.prefetch_distance = readFloat();
+				zone.release_distance = readFloat();
+				unsigned long long count = readVarint();
+				for (unsigned long long i = 0; i < count && !m_read_error; i++)
+				{
+					zone.banks.push_back(readStringRef());
+				}
+				if (m_read_error) { break; }
+				addIdMapping(recorded_id, wrapper.addStreamingZone(zone));
+				break;
+			}
+			case CallRecorder::op_remove_streaming_zone:
+				wrapper.removeStreamingZone(mapId(readVarint()));
+				break;
+			case CallRecorder::op_add_bus_meter:
+			{
+				unsigned long int recorded_id = (unsigned long int)readVarint();
+				std::string bus = readStringRef();
+				if (m_read_error) { break; }
+				addIdMapping(recorded_id, wrapper.addBusMeter(bus));
+				break;
+			}
+			case CallRecorder::op_remove_meter:
+				wrapper.removeMeter(mapId(readVarint()));
+				break;
+			case CallRecorder::op_set_meter_smoothing:
+			{
+				float attack_seconds = readFloat();
+				float release_seconds = readFloat();
+				if (m_read_error) { break; }
+				FmodWrapper::setMeterSmoothing(attack_seconds, release_seconds);
+				break;
+			}
+			case CallRecorder::op_set_emitter_lod_settings:
+			case CallRecorder::op_set_emitter_lod_settings_interpolated:
+			{
+				EmitterLodSettings settings;
+				settings.cell_size = readFloat();
+				settings.near_distance = readFloat();
+				settings.mid_distance = readFloat();
+				settings.mid_interval = (int)readVarint();
+				settings.far_interval = (int)readVarint();
+				settings.movement_threshold = readFloat();
+				// Logs written before the interpolation flag was recorded keep the default.
+				if (op == CallRecorder::op_set_emitter_lod_settings_interpolated) { settings.interpolate = readByte() != 0; }
+				if (m_read_error) { break; }
+				FmodWrapper::setEmitterLodSettings(settings);
+				break;
+			}
+			case CallRecorder::op_restore_audio_state:
+			{
+				int instances_per_update = (int)readVarint();
+				bool stop_current = readByte() != 0;
+				float bank_timeout = readFloat();
+				unsigned long long size = readVarint();
+				if (m_read_error || size > m_data.size() - m_position)
+				{
+					m_read_error = true;
+					break;
+				}
+				std::vector<unsigned char> blob(m_data.begin() + m_position, m_data.begin() + m_position + (size_t)size);
+				m_position += (size_t)size;
+
+				// The restore hands out the new IDs in the blob's order, so the recorded pairs are matched by their saved ID.
+				std::unordered_map<unsigned long int, unsigned long int> recorded_ids;
+				unsigned long long count = readVarint();
+				for (unsigned long long i = 0; i < count && !m_read_error; i++)
+				{
+					unsigned long int saved_id = (unsigned long int)readVarint();
+					recorded_ids[saved_id] = (unsigned long int)readVarint();
+				}
+				if (m_read_error) { break; }
+
+				std::vector<std::pair<unsigned long int, unsigned long int>> id_map;
+				wrapper.restoreAudioState(blob, instances_per_update, stop_current, &id_map, bank_timeout);
+				for (size_t i = 0; i < id_map.size(); i++)
+				{
+					auto find_key = recorded_ids.find(id_map[i].first);
+					if (find_key != recorded_ids.end()) { addIdMapping(find_key->second, id_map[i].second); }
+				}
+				break;
+			}
+			default:
+				// Unknown opcode, the rest of the log can't be parsed reliably.
+				m_read_error = true;
+				break;
+		}
+
+		local_stats.calls++;
+	}
+
+	if (stats != nullptr) { *stats = local_stats; }
+	return m_read_error ? 0 : 1;
+}
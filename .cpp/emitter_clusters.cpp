@@ -0,0 +1,443 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include "emitter_clusters.h"
+
+static float distanceSq(const FMOD_VECTOR& a, const FMOD_VECTOR& b)
+{
+	float dx = a.x - b.x;
+	float dy = a.y - b.y;
+	float dz = a.z - b.z;
+	return dx * dx + dy * dy + dz * dz;
+}
+
+EmitterClusters::EmitterClusters()
+{
+	m_splits = 0;
+	m_merges = 0;
+	m_attribute_writes = 0;
+	m_parameter_writes = 0;
+}
+
+EmitterClusters::~EmitterClusters()
+{
+	// The studio system releases the instances themselves on shutdown.
+	for (size_t i = 0; i < m_groups.size(); i++)
+	{
+		delete m_groups[i];
+	}
+	m_groups.clear();
+}
+
+EmitterClusters::Group* EmitterClusters::findGroup(FMOD::Studio::EventDescription* description) const
+{
+	// Only a handful of clustered events, a scan is cheaper than keeping a second index up to date.
+	if (description == nullptr) { return nullptr; }
+	for (size_t g = 0; g < m_groups.size(); g++)
+	{
+		if (m_groups[g]->description == description) { return m_groups[g]; }
+	}
+	return nullptr;
+}
+
+void EmitterClusters::resolveDescription(Group& group, FMOD::Studio::EventDescription* description)
+{
+	group.description = description;
+	group.has_density = false;
+
+	// Parameter IDs can change when the bank is rebuilt, so they are resolved along with the description.
+	if (!group.settings.density_parameter.empty())
+	{
+		FMOD_STUDIO_PARAMETER_DESCRIPTION parameter_description;
+		if (description->getParameterDescriptionByName(group.settings.density_parameter.c_str(), &parameter_description) == FMOD_OK)
+		{
+			group.density_id = parameter_description.id;
+			group.has_density = true;
+		}
+	}
+}
+
+int EmitterClusters::enable(const std::string& event, FMOD::Studio::EventDescription* description, const EmitterClusterSettings& settings)
+{
+	if (description == nullptr) { return 0; }
+
+	auto find_key = m_group_index.find(event);
+	if (find_key != m_group_index.end())
+	{
+		// Takes effect on the next update. The density parameter stays as resolved.
+		m_groups[find_key->second]->settings = settings;
+		return 1;
+	}
+
+	Group* group = new Group();
+	group->event = event;
+	group->settings = settings;
+	resolveDescription(*group, description);
+
+	m_group_index[event] = m_groups.size();
+	m_groups.push_back(group);
+	return 1;
+}
+
+int EmitterClusters::disable(const std::string& event)
+{
+	auto find_key = m_group_index.find(event);
+	if (find_key == m_group_index.end()) { return 0; }
+
+	size_t index = find_key->second;
+	Group* group = m_groups[index];
+
+	for (size_t c = 0; c < group->clusters.size(); c++)
+	{
+		stopCluster(group->clusters[c]);
+	}
+	for (size_t i = 0; i < group->emitters.size(); i++)
+	{
+		m_emitter_group.erase(group->emitters[i].id);
+	}
+
+	if (index != m_groups.size() - 1)
+	{
+		m_groups[index] = m_groups.back();
+		m_group_index[m_groups[index]->event] = index;
+	}
+	m_groups.pop_back();
+	m_group_index.erase(find_key);
+	delete group;
+	return 1;
+}
+
+int EmitterClusters::add(unsigned long int id, FMOD::Studio::EventDescription* description, const FMOD_VECTOR& position, float weight)
+{
+	if (contains(id)) { return 0; }
+
+	Group* group = findGroup(description);
+	if (group == nullptr) { return 0; }
+
+	// Assigned to a cluster by the next update.
+	Emitter emitter;
+	emitter.id = id;
+	emitter.position = position;
+	emitter.weight = weight > 0.0f ? weight : 1.0f;
+	emitter.cluster = -1;
+
+	group->index[id] = group->emitters.size();
+	group->emitters.push_back(emitter);
+	m_emitter_group[id] = group;
+	return 1;
+}
+
+int EmitterClusters::remove(unsigned long int id)
+{
+	auto find_group = m_emitter_group.find(id);
+	if (find_group == m_emitter_group.end()) { return 0; }
+
+	Group* group = find_group->second;
+	size_t index = group->index[id];
+
+	// The cluster's centre and density catch up on the next update.
+	int cluster = group->emitters[index].cluster;
+	if (cluster != -1) { group->clusters[cluster].members--; }
+
+	if (index != group->emitters.size() - 1)
+	{
+		group->emitters[index] = group->emitters.back();
+		group->index[group->emitters[index].id] = index;
+	}
+	group->emitters.pop_back();
+	group->index.erase(id);
+	m_emitter_group.erase(find_group);
+	return 1;
+}
+
+int EmitterClusters::setPosition(unsigned long int id, const FMOD_VECTOR& position)
+{
+	auto find_group = m_emitter_group.find(id);
+	if (find_group == m_emitter_group.end()) { return 0; }
+
+	Group* group = find_group->second;
+	group->emitters[group->index[id]].position = position;
+	return 1;
+}
+
+int EmitterClusters::createCluster(Group& group, const FMOD_VECTOR& position)
+{
+	Cluster cluster;
+	cluster.instance = nullptr;
+	cluster.centre = position;
+	cluster.sent_centre = position;
+	cluster.total_weight = 0.0f;
+	cluster.members = 0;
+	cluster.sent_members = 0;
+	cluster.merged = false;
+
+	group.clusters.push_back(cluster);
+	return (int)group.clusters.size() - 1;
+}
+
+void EmitterClusters::recomputeCentres(Group& group)
+{
+	for (size_t c = 0; c < group.clusters.size(); c++)
+	{
+		Cluster& cluster = group.clusters[c];
+		cluster.total_weight = 0.0f;
+		cluster.members = 0;
+	}
+
+	std::vector<FMOD_VECTOR> sums(group.clusters.size(), FMOD_VECTOR{ 0.0f, 0.0f, 0.0f });
+	for (size_t i = 0; i < group.emitters.size(); i++)
+	{
+		const Emitter& emitter = group.emitters[i];
+		if (emitter.cluster == -1) { continue; }
+
+		Cluster& cluster = group.clusters[emitter.cluster];
+		sums[emitter.cluster].x += emitter.position.x * emitter.weight;
+		sums[emitter.cluster].y += emitter.position.y * emitter.weight;
+		sums[emitter.cluster].z += emitter.position.z * emitter.weight;
+		cluster.total_weight += emitter.weight;
+		cluster.members++;
+	}
+
+	for (size_t c = 0; c < group.clusters.size(); c++)
+	{
+		Cluster& cluster = group.clusters[c];
+		if (cluster.members == 0) { continue; }
+		cluster.centre.x = sums[c].x / cluster.total_weight;
+		cluster.centre.y = sums[c].y / cluster.total_weight;
+		cluster.centre.z = sums[c].z / cluster.total_weight;
+	}
+}
+
+void EmitterClusters::mergeClusters(Group& group)
+{
+	const float merge_sq = group.settings.merge_distance * group.settings.merge_distance;
+	bool merged_any = false;
+
+	for (size_t a = 0; a < group.clusters.size(); a++)
+	{
+		if (group.clusters[a].merged || group.clusters[a].members == 0) { continue; }
+
+		for (size_t b = a + 1; b < group.clusters.size(); b++)
+		{
+			Cluster& first = group.clusters[a];
+			Cluster& second = group.clusters[b];
+			if (second.merged || second.members == 0) { continue; }
+			if (distanceSq(first.centre, second.centre) > merge_sq) { continue; }
+
+			// The larger cluster keeps playing, so that fewer emitters change instance.
+			int keep = first.members >= second.members ? (int)a : (int)b;
+			int drop = keep == (int)a ? (int)b : (int)a;
+
+			for (size_t i = 0; i < group.emitters.size(); i++)
+			{
+				if (group.emitters[i].cluster == drop) { group.emitters[i].cluster = keep; }
+			}
+			group.clusters[keep].members += group.clusters[drop].members;
+			group.clusters[drop].members = 0;
+			group.clusters[drop].merged = true;
+			merged_any = true;
+			m_merges++;
+
+			if (drop == (int)a) { break; }
+		}
+	}
+
+	if (merged_any) { recomputeCentres(group); }
+}
+
+void EmitterClusters::removeEmptyClusters(Group& group)
+{
+	for (size_t c = 0; c < group.clusters.size();)
+	{
+		if (group.clusters[c].members > 0)
+		{
+			group.clusters[c].merged = false;
+			c++;
+			continue;
+		}
+
+		stopCluster(group.clusters[c]);
+
+		// Swap the last cluster into the slot and re-point its emitters.
+		int last = (int)group.clusters.size() - 1;
+		if ((int)c != last)
+		{
+			group.clusters[c] = group.clusters[last];
+			for (size_t i = 0; i < group.emitters.size(); i++)
+			{
+				if (group.emitters[i].cluster == last) { group.emitters[i].cluster = (int)c; }
+			}
+		}
+		group.clusters.pop_back();
+	}
+}
+
+void EmitterClusters::updateGroup(Group& group)
+{
+	const float join_sq = group.settings.join_radius * group.settings.join_radius;
+	const float leave_sq = group.settings.leave_radius * group.settings.leave_radius;
+
+	// 1. Emitters that have wandered past the leave radius of last update's centre drop out.
+	std::vector<bool> was_clustered(group.emitters.size(), false);
+	for (size_t i = 0; i < group.emitters.size(); i++)
+	{
+		Emitter& emitter = group.emitters[i];
+		if (emitter.cluster == -1) { continue; }
+
+		was_clustered[i] = true;
+		if (distanceSq(emitter.position, group.clusters[emitter.cluster].centre) > leave_sq) { emitter.cluster = -1; }
+	}
+	recomputeCentres(group);
+
+	// 2. Unassigned emitters join the closest cluster in reach, or start their own.
+	for (size_t i = 0; i < group.emitters.size(); i++)
+	{
+		Emitter& emitter = group.emitters[i];
+		if (emitter.cluster != -1) { continue; }
+
+		int closest = -1;
+		float closest_sq = join_sq;
+		for (size_t c = 0; c < group.clusters.size(); c++)
+		{
+			if (group.clusters[c].members == 0) { continue; }
+			float distance_sq = distanceSq(emitter.position, group.clusters[c].centre);
+			if (distance_sq <= closest_sq)
+			{
+				closest = (int)c;
+				closest_sq = distance_sq;
+			}
+		}
+
+		if (closest == -1)
+		{
+			closest = createCluster(group, emitter.position);
+			if (was_clustered[i]) { m_splits++; }
+		}
+
+		// Running weighted mean, so that the following emitters see the grown cluster.
+		Cluster& cluster = group.clusters[closest];
+		float total_weight = cluster.total_weight + emitter.weight;
+		cluster.centre.x += (emitter.position.x - cluster.centre.x) * emitter.weight / total_weight;
+		cluster.centre.y += (emitter.position.y - cluster.centre.y) * emitter.weight / total_weight;
+		cluster.centre.z += (emitter.position.z - cluster.centre.z) * emitter.weight / total_weight;
+		cluster.total_weight = total_weight;
+		cluster.members++;
+		emitter.cluster = closest;
+	}
+
+	// 3. Clusters that have drifted together become one.
+	mergeClusters(group);
+	removeEmptyClusters(group);
+
+	apply(group);
+}
+
+void EmitterClusters::apply(Group& group)
+{
+	const float threshold_sq = group.settings.movement_threshold * group.settings.movement_threshold;
+
+	for (size_t c = 0; c < group.clusters.size(); c++)
+	{
+		Cluster& cluster = group.clusters[c];
+
+		FMOD_3D_ATTRIBUTES attributes;
+		attributes.position = cluster.centre;
+		attributes.velocity = { 0.0f, 0.0f, 0.0f };
+		attributes.forward = { 0.0f, 0.0f, 1.0f };
+		attributes.up = { 0.0f, 1.0f, 0.0f };
+
+		if (cluster.instance == nullptr)
+		{
+			if (group.description->createInstance(&cluster.instance) != FMOD_OK)
+			{
+				cluster.instance = nullptr;
+				continue;
+			}
+			cluster.instance->set3DAttributes(&attributes);
+			if (group.has_density) { cluster.instance->setParameterByID(group.density_id, (float)cluster.members, true); }
+			cluster.instance->start();
+
+			cluster.sent_centre = cluster.centre;
+			cluster.sent_members = cluster.members;
+			m_attribute_writes++;
+			continue;
+		}
+
+		if (distanceSq(cluster.centre, cluster.sent_centre) >= threshold_sq)
+		{
+			cluster.instance->set3DAttributes(&attributes);
+			cluster.sent_centre = cluster.centre;
+			m_attribute_writes++;
+		}
+
+		if (group.has_density && cluster.members != cluster.sent_members)
+		{
+			cluster.instance->setParameterByID(group.density_id, (float)cluster.members);
+			cluster.sent_members = cluster.members;
+			m_parameter_writes++;
+		}
+	}
+}
+
+void EmitterClusters::stopCluster(Cluster& cluster)
+{
+	if (cluster.instance == nullptr) { return; }
+	cluster.instance->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT);
+	cluster.instance->release();
+	cluster.instance = nullptr;
+}
+
+void EmitterClusters::dropClusters(Group& group)
+{
+	for (size_t c = 0; c < group.clusters.size(); c++)
+	{
+		stopCluster(group.clusters[c]);
+	}
+	group.clusters.clear();
+	for (size_t i = 0; i < group.emitters.size(); i++)
+	{
+		group.emitters[i].cluster = -1;
+	}
+}
+
+void EmitterClusters::update(FMOD::Studio::System* system)
+{
+	m_attribute_writes = 0;
+	m_parameter_writes = 0;
+
+	for (size_t g = 0; g < m_groups.size(); g++)
+	{
+		Group& group = *m_groups[g];
+
+		// The event's bank has been unloaded or reloaded. Its instances went with it, and the description may now
+		// belong to a rebuilt version of the bank, so the event is looked up again by its path.
+		if (group.description == nullptr || !group.description->isValid())
+		{
+			if (group.description != nullptr)
+			{
+				dropClusters(group);
+				group.description = nullptr;
+			}
+
+			FMOD::Studio::EventDescription* description = nullptr;
+			if (system->getEvent(group.event.c_str(), &description) != FMOD_OK || description == nullptr) { continue; }
+			resolveDescription(group, description);
+		}
+		updateGroup(group);
+	}
+}
+
+EmitterClusterStats EmitterClusters::getStats() const
+{
+	EmitterClusterStats stats;
+	for (size_t g = 0; g < m_groups.size(); g++)
+	{
+		stats.emitters += (unsigned long int)m_groups[g]->emitters.size();
+		stats.clusters += (unsigned long int)m_groups[g]->clusters.size();
+	}
+	stats.splits = m_splits;
+	stats.merges = m_merges;
+	stats.attribute_writes_last_update = m_attribute_writes;
+	stats.parameter_writes_last_update = m_parameter_writes;
+	return stats;
+}
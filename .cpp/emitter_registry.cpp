@@ -0,0 +1,287 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cmath>
+#include <algorithm>
+#include "emitter_registry.h"
+
+EmitterRegistry::EmitterRegistry()
+{
+	m_tick = 0;
+}
+
+long long EmitterRegistry::cellKey(int x, int y, int z) const
+{
+	// 21 bits per axis is plenty for any sensible world size / cell size combination.
+	const long long mask = (1 << 21) - 1;
+	return (((long long)x & mask) << 42) | (((long long)y & mask) << 21) | ((long long)z & mask);
+}
+
+long long EmitterRegistry::cellOf(const FMOD_VECTOR& position) const
+{
+	int x = (int)std::floor(position.x / m_settings.cell_size);
+	int y = (int)std::floor(position.y / m_settings.cell_size);
+	int z = (int)std::floor(position.z / m_settings.cell_size);
+	return cellKey(x, y, z);
+}
+
+void EmitterRegistry::insertIntoCell(long long cell, unsigned long int id)
+{
+	m_cells[cell].push_back(id);
+}
+
+void EmitterRegistry::removeFromCell(long long cell, unsigned long int id)
+{
+	auto find_key = m_cells.find(cell);
+	if (find_key == m_cells.end()) { return; }
+
+	std::vector<unsigned long int>& ids = find_key->second;
+	auto it = std::find(ids.begin(), ids.end(), id);
+	if (it != ids.end())
+	{
+		*it = ids.back();
+		ids.pop_back();
+	}
+	if (ids.empty()) { m_cells.erase(find_key); }
+}
+
+void EmitterRegistry::rebuildCells()
+{
+	m_cells.clear();
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		m_emitters[i].cell = cellOf(m_emitters[i].target.position);
+		insertIntoCell(m_emitters[i].cell, m_emitters[i].id);
+	}
+}
+
+int EmitterRegistry::add(unsigned long int id, FMOD::Studio::EventInstance* instance)
+{
+	if (contains(id)) { return 0; }
+
+	Emitter emitter;
+	emitter.id = id;
+	emitter.instance = instance;
+	if (instance->get3DAttributes(&emitter.target) != FMOD_OK) { return 0; }
+	emitter.sent = emitter.target;
+	emitter.cell = cellOf(emitter.target.position);
+	emitter.next_update_tick = m_tick;
+	emitter.time_since_sent = 0.0f;
+	emitter.dirty = false;
+	emitter.glide_from = emitter.target.position;
+	emitter.glide_step = 0;
+	emitter.glide_steps = 0;
+
+	m_index[id] = m_emitters.size();
+	m_emitters.push_back(emitter);
+	insertIntoCell(emitter.cell, id);
+	m_stats.emitters = (unsigned long int)m_emitters.size();
+	return 1;
+}
+
+int EmitterRegistry::remove(unsigned long int id)
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return 0; }
+
+	size_t index = find_key->second;
+	removeFromCell(m_emitters[index].cell, id);
+
+	if (index != m_emitters.size() - 1)
+	{
+		m_emitters[index] = m_emitters.back();
+		m_index[m_emitters[index].id] = index;
+	}
+	m_emitters.pop_back();
+	m_index.erase(id);
+	m_stats.emitters = (unsigned long int)m_emitters.size();
+	return 1;
+}
+
+int EmitterRegistry::setAttributes(unsigned long int id, const FMOD_3D_ATTRIBUTES& attributes)
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return 0; }
+
+	Emitter& emitter = m_emitters[find_key->second];
+	emitter.target = attributes;
+	emitter.dirty = true;
+
+	long long cell = cellOf(attributes.position);
+	if (cell != emitter.cell)
+	{
+		removeFromCell(emitter.cell, id);
+		insertIntoCell(cell, id);
+		emitter.cell = cell;
+	}
+	return 1;
+}
+
+void EmitterRegistry::setSettings(const EmitterLodSettings& settings)
+{
+	bool cell_size_changed = settings.cell_size != m_settings.cell_size;
+	m_settings = settings;
+	if (m_settings.cell_size <= 0.0f) { m_settings.cell_size = 1.0f; }
+	if (cell_size_changed) { rebuildCells(); }
+}
+
+float EmitterRegistry::closestListenerDistanceSq(const FMOD_VECTOR& position, const FMOD_3D_ATTRIBUTES* listeners, int num_listeners) const
+{
+	float closest = -1.0f;
+	for (int i = 0; i < num_listeners; i++)
+	{
+		float dx = position.x - listeners[i].position.x;
+		float dy = position.y - listeners[i].position.y;
+		float dz = position.z - listeners[i].position.z;
+		float distance_sq = dx * dx + dy * dy + dz * dz;
+		if (closest < 0.0f || distance_sq < closest) { closest = distance_sq; }
+	}
+	return closest;
+}
+
+void EmitterRegistry::glide(Emitter& emitter)
+{
+	emitter.glide_step++;
+
+	FMOD_3D_ATTRIBUTES attributes = emitter.target;
+	if (emitter.glide_step < emitter.glide_steps)
+	{
+		// Only the position is interpolated, blended orientation vectors wouldn't stay orthonormal.
+		float t = (float)emitter.glide_step / (float)emitter.glide_steps;
+		attributes.position.x = emitter.glide_from.x + (emitter.target.position.x - emitter.glide_from.x) * t;
+		attributes.position.y = emitter.glide_from.y + (emitter.target.position.y - emitter.glide_from.y) * t;
+		attributes.position.z = emitter.glide_from.z + (emitter.target.position.z - emitter.glide_from.z) * t;
+	}
+	send(emitter, attributes);
+}
+
+void EmitterRegistry::send(Emitter& emitter, const FMOD_3D_ATTRIBUTES& attributes)
+{
+	FMOD_3D_ATTRIBUTES sent = attributes;
+
+	// If the game doesn't provide a velocity, derive it from the distance travelled since the last send, so that doppler follows the glide.
+	bool has_velocity = sent.velocity.x != 0.0f || sent.velocity.y != 0.0f || sent.velocity.z != 0.0f;
+	if (!has_velocity && emitter.time_since_sent > 0.0f)
+	{
+		sent.velocity.x = (sent.position.x - emitter.sent.position.x) / emitter.time_since_sent;
+		sent.velocity.y = (sent.position.y - emitter.sent.position.y) / emitter.time_since_sent;
+		sent.velocity.z = (sent.position.z - emitter.sent.position.z) / emitter.time_since_sent;
+	}
+
+	emitter.instance->set3DAttributes(&sent);
+	emitter.sent = attributes;
+	emitter.time_since_sent = 0.0f;
+	emitter.dirty = false;
+	m_stats.sent_last_update++;
+}
+
+bool EmitterRegistry::moved(const FMOD_3D_ATTRIBUTES& target, const FMOD_3D_ATTRIBUTES& sent, float threshold_sq) const
+{
+	float dx = target.position.x - sent.position.x;
+	float dy = target.position.y - sent.position.y;
+	float dz = target.position.z - sent.position.z;
+	if (dx * dx + dy * dy + dz * dz >= threshold_sq) { return true; }
+
+	// A turning or accelerating emitter that stays in place still changes its cone and doppler.
+	const FMOD_VECTOR* a[3] = { &target.velocity, &target.forward, &target.up };
+	const FMOD_VECTOR* b[3] = { &sent.velocity, &sent.forward, &sent.up };
+	for (int i = 0; i < 3; i++)
+	{
+		float vx = a[i]->x - b[i]->x;
+		float vy = a[i]->y - b[i]->y;
+		float vz = a[i]->z - b[i]->z;
+		if (vx * vx + vy * vy + vz * vz >= threshold_sq) { return true; }
+	}
+	return false;
+}
+
+void EmitterRegistry::update(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners, float delta_time)
+{
+	m_tick++;
+	m_stats.sent_last_update = 0;
+	m_stats.skipped_last_update = 0;
+
+	if (m_emitters.empty() || num_listeners <= 0) { return; }
+
+	const float threshold_sq = m_settings.movement_threshold * m_settings.movement_threshold;
+	const float near_sq = m_settings.near_distance * m_settings.near_distance;
+	const float mid_sq = m_settings.mid_distance * m_settings.mid_distance;
+
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		m_emitters[i].time_since_sent += delta_time;
+	}
+
+	// 1. Near band: visit only the grid cells around each listener, these emitters are updated every tick.
+	int reach = (int)std::ceil(m_settings.near_distance / m_settings.cell_size);
+	for (int l = 0; l < num_listeners; l++)
+	{
+		const FMOD_VECTOR& listener = listeners[l].position;
+		int lx = (int)std::floor(listener.x / m_settings.cell_size);
+		int ly = (int)std::floor(listener.y / m_settings.cell_size);
+		int lz = (int)std::floor(listener.z / m_settings.cell_size);
+
+		for (int x = lx - reach; x <= lx + reach; x++)
+		for (int y = ly - reach; y <= ly + reach; y++)
+		for (int z = lz - reach; z <= lz + reach; z++)
+		{
+			auto find_key = m_cells.find(cellKey(x, y, z));
+			if (find_key == m_cells.end()) { continue; }
+
+			const std::vector<unsigned long int>& ids = find_key->second;
+			for (size_t k = 0; k < ids.size(); k++)
+			{
+				Emitter& emitter = m_emitters[m_index[ids[k]]];
+				if (emitter.next_update_tick <= m_tick) { continue; }
+
+				float dx = emitter.target.position.x - listener.x;
+				float dy = emitter.target.position.y - listener.y;
+				float dz = emitter.target.position.z - listener.z;
+				if (dx * dx + dy * dy + dz * dz > near_sq) { continue; }
+
+				// A listener has moved close to an emitter on a reduced rate. Marking it as due lets the scan below handle it like any other.
+				emitter.next_update_tick = m_tick;
+			}
+		}
+	}
+
+	// 2. Everything that is due this tick: schedule the next update based on the distance band, then send if it moved or turned.
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		Emitter& emitter = m_emitters[i];
+		if (emitter.next_update_tick > m_tick)
+		{
+			// Between two due ticks a moving emitter takes one step of its glide.
+			if (emitter.glide_step < emitter.glide_steps) { glide(emitter); }
+			continue;
+		}
+
+		int interval = m_settings.far_interval;
+		float distance_sq = closestListenerDistanceSq(emitter.target.position, listeners, num_listeners);
+		if (distance_sq <= near_sq) { interval = 1; }
+		else if (distance_sq <= mid_sq) { interval = m_settings.mid_interval; }
+		emitter.next_update_tick = m_tick + interval;
+
+		// A new glide starts from wherever the previous one got to.
+		emitter.glide_step = 0;
+		emitter.glide_steps = 0;
+
+		if (emitter.dirty)
+		{
+			if (moved(emitter.target, emitter.sent, threshold_sq))
+			{
+				emitter.glide_from = emitter.sent.position;
+				emitter.glide_steps = m_settings.interpolate && interval > 1 ? interval : 1;
+				glide(emitter);
+			}
+			else
+			{
+				emitter.dirty = false;
+				m_stats.skipped_last_update++;
+			}
+		}
+	}
+
+	m_stats.sent_total += m_stats.sent_last_update;
+	m_stats.skipped_total += m_stats.skipped_last_update;
+}
@@ -1,806 +1,3826 @@
-MIT License
-Copyright (c) 2020 Ville Ojala
-
-#include "fmod_wrapper.h"
-
-WrapperImplementation* audio_engine = nullptr;
-IdSystem* id_system = nullptr;
-
-bool FmodWrapper::audio_engine_initialized = false;
-std::map<std::string, float> FmodWrapper::empty_map;
-
-WrapperImplementation::WrapperImplementation()
-{
-	studio_system = nullptr;
-	FmodWrapper::errorCheck(FMOD::Studio::System::create(&studio_system));
-	core_system = nullptr;
-	FmodWrapper::errorCheck(studio_system->getCoreSystem(&core_system));
-	FmodWrapper::errorCheck(studio_system->initialize(1024, FMOD_STUDIO_INIT_NORMAL, FMOD_INIT_NORMAL, NULL));
-	core_system->setSoftwareFormat(0, FMOD_SPEAKERMODE_STEREO, 0);
-}
-
-WrapperImplementation::~WrapperImplementation()
-{
-	FmodWrapper::errorCheck(studio_system->unloadAll());
-	FmodWrapper::errorCheck(studio_system->release());
-
-	if (!m_alloc_dialogue_user_data.empty())
-	{
-		for (auto it = m_alloc_dialogue_user_data.begin(); it != m_alloc_dialogue_user_data.end(); ++it)
-		{
-			if (it->second != nullptr)
-			{
-				DialogueUserData* data = it->second;
-				delete data;
-				it->second = nullptr;
-			}
-		}
-		m_alloc_dialogue_user_data.clear();
-	}
-}
-
-void WrapperImplementation::runUpdate()
-{
-	if (!m_events.empty())
-	{
-		for (auto it = m_events.begin(); it != m_events.end();)
-		{
-			bool event_valid = it->second->isValid();
-
-			if (event_valid == false) 
-			{
-				std::cout << "Erased ID: " << it->first << std::endl; // Temp debug print.
-				m_events.erase(it++);
-				continue;
-			}
-
-			FMOD_STUDIO_PLAYBACK_STATE pb_state;
-			it->second->getPlaybackState(&pb_state);
-
-			if (pb_state == FMOD_STUDIO_PLAYBACK_STOPPED)
-			{
-				FmodWrapper::errorCheck(it->second->release());
-				std::cout << "Erased ID: " << it->first << std::endl; // Temp debug print.
-				m_events.erase(it++);
-				continue;
-			}
-
-			++it;
-		}
-	}
-	studio_system->update();
-}
-
-
-void FmodWrapper::initializeAudioEngine()
-{
-	if (audio_engine_initialized)
-	{
-		// Warn here about trying to initialize multiple audio engines.
-		return;
-	}
-
-	audio_engine = new WrapperImplementation;
-	bool engine_is_valid = audio_engine->studio_system->isValid();
-	if (!engine_is_valid) 
-	{
-		// Add game engine console error message here.
-	}
-	else
-	{	
-		initializeIdSystem();
-
-		int e;
-		
-		// Load master bank and the master string bank. Add project specific locations here.
-		std::string master_bank_location = "D:/FmodTestProject/Build/Desktop/Master.bank";
-		std::string master_bank_strings_location = "D:/FmodTestProject/Build/Desktop/Master.strings.bank";
-		
-		FMOD::Studio::Bank* b_master = nullptr;
-		e = errorCheck(audio_engine->studio_system->loadBankFile(master_bank_location.c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &b_master));
-		if (e == 1) { return; }
-
-		FMOD::Studio::Bank* b_master_strings = nullptr;
-		e = errorCheck(audio_engine->studio_system->loadBankFile(master_bank_strings_location.c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &b_master_strings));
-		if (e == 1) { return; }
-
-		audio_engine->m_banks[master_bank_location] = b_master;
-		audio_engine->m_banks[master_bank_strings_location] = b_master_strings;
-
-		// Hard coded with one listener, change as necessary;
-		e = setNumberOfListeners(1);
-		// If setting up listeners failed, abort initialization. Add error message to the game engine console.
-		if (e == 0) { return; }
-
-		// Setting up some default listener 3D attributes for debugging purposes in the absence of an available game engine. Remove when doing a real integration!
-		FMOD_3D_ATTRIBUTES default_attributes;
-		default_attributes.position = { 0.0f, 0.0f, 0.0f };
-		default_attributes.velocity = { 0.0f, 0.0f, 0.0f };
-		default_attributes.forward = { 0.0f, 0.0f, 1.0f };
-		default_attributes.up = { 0.0f, 1.0f, 0.0f };
-
-		setListenerAttributes(1, default_attributes);
-
-		audio_engine_initialized = true;
-		std::cout << "Audio engine initialized!\n" << std::endl; // Temp debug print.
-		audio_engine->runUpdate();
-	}
-}
-
-void FmodWrapper::initializeIdSystem()
-{
-	id_system = new IdSystem;
-}
-
-int FmodWrapper::setNumberOfListeners(int num_listeners)
-{
-	int e;
-	e = errorCheck(audio_engine->studio_system->setNumListeners(num_listeners));
-	if (e == 1) { return 0; }
-	return 1;
-}
-
-void FmodWrapper::callUpdate()
-{
-	if (!audio_engine_initialized) { return; }
-	audio_engine->runUpdate();
-}
-
-void FmodWrapper::shutDownAudioEngine()
-{
-	if (!audio_engine_initialized) { return; }
-	delete audio_engine;
-	delete id_system;
-	audio_engine = nullptr;
-	id_system = nullptr;
-	audio_engine_initialized = false;
-	std::cout << "Audio engine was shut down!" << std::endl;
-}
-
-int FmodWrapper::errorCheck(FMOD_RESULT result)
-{
-	if (result != FMOD_OK)
-	{
-		// Remember to change the output to the console of the deployed game engine.
-		std::cout << "FMOD ERROR " << result << std::endl;
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::loadBank(const std::string& bank, bool load_samples)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_banks.find(bank);
-
-	if (find_key != audio_engine->m_banks.end())
-	{
-		// Bank is already loaded.
-		// If the sample data for this metadata is not yet loaded, use the loadSampleData function.
-
-		return 0;
-	}
-
-	FMOD::Studio::Bank* b = nullptr;
-	int e;
-	e = errorCheck(audio_engine->studio_system->loadBankFile(bank.c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &b));
-	if (e == 1) { return 0; }
-
-	if (load_samples)
-	{
-		e = errorCheck(b->loadSampleData());
-		if (e == 1)
-		{
-			b->unload();
-			return 0;
-		}
-		else
-		{
-			audio_engine->m_banks[bank] = b;
-			return 1;
-		}
-	}
-	else
-	{
-		audio_engine->m_banks[bank] = b;
-		return 1;
-	}	
-}
-
-int FmodWrapper::unloadBank(const std::string& bank)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_banks.find(bank);
-
-	if (find_key == audio_engine->m_banks.end())
-	{
-		// Bank requested for unloading is not loaded.
-		return 0;
-	}
-	else
-	{
-		int e;
-		e = errorCheck(find_key->second->unload());
-		if (e == 1) { return 0; }
-		
-		audio_engine->m_banks.erase(find_key);
-		return 1;
-	}
-}
-
-int FmodWrapper::loadSampleData(const std::string& bank)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_banks.find(bank);
-
-	if (find_key == audio_engine->m_banks.end())
-	{
-		// Bank metadata has not been loaded.
-		return 0;
-	}
-	else
-	{
-		int e;
-
-		FMOD_STUDIO_LOADING_STATE loading_state;
-		e = errorCheck(find_key->second->getSampleLoadingState(&loading_state));
-		if (e == 1) { return 0; }
-		
-		switch (loading_state)
-		{
-			case FMOD_STUDIO_LOADING_STATE_UNLOADING:
-				 // Debug message the reason of cancelling the sample data load to the game engine console?
-				 return 0;
-			case FMOD_STUDIO_LOADING_STATE_UNLOADED:
-				 e = errorCheck(find_key->second->loadSampleData());
-				 if (e == 1) { return 0; }
-				 else { return 1; }		
-			case FMOD_STUDIO_LOADING_STATE_LOADING:
-				 // Debug message the reason of cancelling the sample data load to the game engine console?
-				 return 0;
-			case FMOD_STUDIO_LOADING_STATE_LOADED:
-			     // Debug message the reason of cancelling the sample data load to the game engine console?
-				 return 0;
-			case FMOD_STUDIO_LOADING_STATE_ERROR:
-				 e = errorCheck(find_key->second->loadSampleData());
-				 if (e == 1) { return 0; }
-				 else { return 1; }
-			default:
-				 return 0;
-		}
-	}
-}
-
-int FmodWrapper::unloadSampleData(const std::string& bank)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_banks.find(bank);
-
-	if (find_key == audio_engine->m_banks.end())
-	{
-		// Bank metadata has not been loaded.
-		return 0;
-	}
-	else
-	{
-		int e;
-
-		FMOD_STUDIO_LOADING_STATE loading_state;
-		e = errorCheck(find_key->second->getSampleLoadingState(&loading_state));
-		if (e == 1) { return 0; }
-
-		switch (loading_state)
-		{
-		case FMOD_STUDIO_LOADING_STATE_UNLOADING:
-			// Debug message the reason of cancelling the sample data load to the game engine console?
-			return 0;
-		case FMOD_STUDIO_LOADING_STATE_UNLOADED:
-			// Debug message the reason of cancelling the sample data load to the game engine console?
-			return 0;
-		case FMOD_STUDIO_LOADING_STATE_LOADING:
-			// Debug message the reason of cancelling the sample data load to the game engine console?
-			return 0;
-		case FMOD_STUDIO_LOADING_STATE_LOADED:
-			e = errorCheck(find_key->second->unloadSampleData());
-			if (e == 1) { return 0; }
-			else { return 1; }
-		case FMOD_STUDIO_LOADING_STATE_ERROR:
-			e = errorCheck(find_key->second->unloadSampleData());
-			if (e == 1) { return 0; }
-			else { return 1; }
-		default:
-			return 0;
-		}
-	}
-}
-
-
-// "play3dEvent", "play2dEvent", "playDialogue3D" & "playDialogue2D"  -functions return a unique event instance ID to the caller. 
-// If necessary, caller can then later use this ID to update FMOD_3D_ATTRIBUTES and local parameters possibly assigned to the particular event instance.
-// Initial parameter values can be optionally provided in the function arguments.
-// For mixer snapshots, the same play and stop functions can be used for activation and inactivation.
-
-unsigned long int FmodWrapper::play3DEvent(const std::string& event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	FMOD::Studio::EventDescription* event_description = nullptr;
-	int e = errorCheck(audio_engine->studio_system->getEvent(event.c_str(), &event_description));
-	if (e == 1) { return 0; }
-
-	FMOD::Studio::EventInstance* event_instance = nullptr;
-	e = errorCheck(event_description->createInstance(&event_instance));
-	if (e == 1) { return 0; }
-
-	bool is_3d = false;
-	event_description->is3D(&is_3d);
-
-	if (is_3d)
-	{
-		e = errorCheck(event_instance->set3DAttributes(&spatial_attributes));
-		if (e == 1) { return 0; }
-	}
-	else
-	{
-		return 0;
-	}
-
-	if (!parameters.empty())
-	{
-		for(auto it = parameters.begin();  it != parameters.end(); it++)
-		{
-			std::string parameter = it->first;
-			float value = it->second;
-			errorCheck(event_instance->setParameterByName(parameter.c_str(), value, false));
-		}
-	}
-
-	if (id_system != nullptr)
-	{
-		unsigned long int id = id_system->getUniqueId();
-		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
-
-		e = errorCheck(event_instance->start());
-		if (e == 1) { return 0; }
-
-		return id;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-unsigned long int FmodWrapper::play2DEvent(const std::string& event, std::map<std::string, float> parameters)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	FMOD::Studio::EventDescription* event_description = nullptr;
-	int e = errorCheck(audio_engine->studio_system->getEvent(event.c_str(), &event_description));
-	if (e == 1) { return 0; }
-
-	FMOD::Studio::EventInstance* event_instance = nullptr;
-	e = errorCheck(event_description->createInstance(&event_instance));
-	if (e == 1) { return 0; }
-
-	if (!parameters.empty())
-	{
-		for (auto it = parameters.begin(); it != parameters.end(); it++)
-		{
-			std::string parameter = it->first;
-			float value = it->second;
-			errorCheck(event_instance->setParameterByName(parameter.c_str(), value, false));
-		}
-	}
-
-	if (id_system != nullptr)
-	{
-		unsigned long int id = id_system->getUniqueId();
-		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
-
-		e = errorCheck(event_instance->start());
-		if (e == 1) { return 0; }
-		
-		return id;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::stopEvent(int event_id, bool allow_fades)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_events.find(event_id);
-
-	if (find_key != audio_engine->m_events.end())
-	{
-		int e;
-
-		if (allow_fades)
-		{
-			e = errorCheck(find_key->second->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
-			if (e == 1) { return 0; }
-			return 1;
-		}
-		else
-		{
-			e = errorCheck(find_key->second->stop(FMOD_STUDIO_STOP_IMMEDIATE));
-			if (e == 1) { return 0; }
-			return 1;
-		}
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::set3DAttributes(int event_id, FMOD_3D_ATTRIBUTES spatial_attributes)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_events.find(event_id);
-
-	if (find_key != audio_engine->m_events.end())
-	{
-		int e;
-
-		e = errorCheck(find_key->second->set3DAttributes(&spatial_attributes));
-		if (e == 1) { return 0; }
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::setListenerAttributes(int listener_index, FMOD_3D_ATTRIBUTES spatial_attributes)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	int e;
-
-	e = errorCheck(audio_engine->studio_system->setListenerAttributes(listener_index, &spatial_attributes));
-	if (e == 1) { return 0; }
-	return 1;
-}
-
-int FmodWrapper::setParameterByName(int event_id, std::string& parameter, float value)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	auto find_key = audio_engine->m_events.find(event_id);
-
-	if (find_key != audio_engine->m_events.end())
-	{
-		int e;
-		e = errorCheck(find_key->second->setParameterByName(parameter.c_str(), value));
-		if (e == 1) { return 0; }
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::setGlobalParameterByName(std::string& parameter, float value)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	int e;
-
-	e = errorCheck(audio_engine->studio_system->setParameterByName(parameter.c_str(), value, false));
-	if (e == 1) { return 0; }
-	return 1;
-}
-
-int FmodWrapper::setBusPauseStatus(const std::string& bus, bool is_paused)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	int e;
-
-	FMOD::Studio::Bus* b = nullptr;
-	e = errorCheck(audio_engine->studio_system->getBus(bus.c_str(), &b));
-	
-	bool bus_is_valid = b->isValid();
-
-	if (bus_is_valid)
-	{
-		b->setPaused(is_paused);
-		return 1;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-int FmodWrapper::stopAllBusEvents(const std::string& bus, bool allow_fades)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	int e;
-
-	FMOD::Studio::Bus* b = nullptr;
-	e = errorCheck(audio_engine->studio_system->getBus(bus.c_str(), &b));
-
-	bool bus_is_valid = b->isValid();
-
-	if (bus_is_valid)
-	{
-		int e;
-
-		if (allow_fades)
-		{
-			e = errorCheck(b->stopAllEvents(FMOD_STUDIO_STOP_ALLOWFADEOUT));
-			if (e == 1) { return 0; }
-			return 1;
-		}
-		else
-		{
-			e = errorCheck(b->stopAllEvents(FMOD_STUDIO_STOP_IMMEDIATE));
-			if (e == 1) { return 0; }
-			return 1;
-		}
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-FMOD_RESULT F_CALLBACK FmodWrapper::dialogueEventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void *parameter)
-{
-	int e;
-	auto instance = (FMOD::Studio::EventInstance*)event;
-	void* user_data = nullptr;
-	e = errorCheck(instance->getUserData(&user_data));
-
-	switch (type)
-	{
-		case FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND:
-		{
-			std::cout << "Created a programmer sound" << std::endl; // Temp debug print.
-
-			DialogueUserData dialogue_user_data = *(DialogueUserData*)user_data;
-			FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES* properties = (FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES*)parameter;
-			FMOD_STUDIO_SOUND_INFO sound_info;
-			e = errorCheck(audio_engine->studio_system->getSoundInfo(dialogue_user_data.line_key.c_str(), &sound_info));
-			if (e == 1) { break; }
-
-			FMOD_MODE sound_mode = FMOD_DEFAULT;
-			sound_mode |= FMOD_LOOP_NORMAL;
-			//sound_mode |= FMOD_CREATECOMPRESSEDSAMPLE; 
-			sound_mode |= FMOD_NONBLOCKING;
-
-			if (dialogue_user_data.is_3d)
-			{
-				sound_mode |= FMOD_3D;
-			}
-
-			FMOD::Sound* dialogue_sound = nullptr;
-			e = errorCheck(audio_engine->core_system->createSound(sound_info.name_or_data, sound_mode, &sound_info.exinfo, &dialogue_sound)); 
-
-			if (e == 1) { break; }
-
-			FMOD_SOUND* cast_dialogue_sound = (FMOD_SOUND*)dialogue_sound;
-			properties->sound = cast_dialogue_sound;
-			properties->subsoundIndex = sound_info.subsoundindex;
-		}
-		break;
-	
-		case FMOD_STUDIO_EVENT_CALLBACK_STOPPED:
-		{
-			std::cout << "An event stopped" << std::endl;  // Temp debug print.	
-			instance->release();			
-		}
-		break;
-
-		//  When this callback happens, inform the dialogue system that the current line has finished.
-		//  Maybe also add another system on the game engine side that allows for a wait before the next line is triggered for dialogue pacing purposes.
-		//  Interrupting lines are their own special case, since the next line has to be triggered before the current one has been destoryed.
-		case FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND: 
-		{			
-			std::cout << "Destroyed a programmer sound" << std::endl; // Temp debug print.	
-			FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES* properties = (FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES*)parameter;
-			FMOD::Sound* cast_dialogue_sound = (FMOD::Sound*)properties->sound;
-			cast_dialogue_sound->release();			
-		}
-		break;
-
-		case FMOD_STUDIO_EVENT_CALLBACK_DESTROYED:
-		{
-			std::cout << "Destroyed an event" << std::endl; // Temp debug print.
-			DialogueUserData dialogue_user_data = *(DialogueUserData*)user_data;			
-			audio_engine->m_alloc_dialogue_user_data.erase(dialogue_user_data.associated_event_id);
-			delete user_data;
-			user_data = nullptr;
-		}
-		break;
-	}
-	return FMOD_OK;
-}
-
-unsigned long int FmodWrapper::playDialogue3D(const std::string key, DialogueMasterEvents master_event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters)
-{
-	if (!audio_engine_initialized) { return 0; }
-
-	std::string dialogue_master_event;
-
-	switch (master_event)
-	{
-		case PC:
-			dialogue_master_event = "event:/PC_Dialogue_Master";
-			break;
-		case NPC:
-			dialogue_master_event = "event:/NPC_Dialogue_Master";
-			break;
-		default:
-			return 0;
-	}
-
-	FMOD::Studio::EventDescription* dialogue_event_description = nullptr;
-	int e = errorCheck(audio_engine->studio_system->getEvent(dialogue_master_event.c_str(), &dialogue_event_description));
-	if (e == 1) { return 0; } 
-
-	FMOD::Studio::EventInstance* dialogue_event_instance = nullptr;
-	e = errorCheck(dialogue_event_description->createInstance(&dialogue_event_instance));
-	if (e == 1) { return 0; } 
-
-	bool is_3d = false;
-	dialogue_event_description->is3D(&is_3d);
-
-	if (is_3d)
-	{
-		e = errorCheck(dialogue_event_instance->set3DAttributes(&spatial_attributes));
-		if (e == 1) { return 0; }
-	}
-	else
-	{
-		return 0;
-	}
-
-	if (!parameters.empty())
-	{
-		for (auto it = parameters.begin(); it != parameters.end(); it++)
-		{
-			std::string parameter = it->first;
-			float value = it->second;
-			errorCheck(dialogue_event_instance->setParameterByName(parameter.c_str(), value, false));
-		}
-	}
-
-	if (id_system != nullptr)
-	{
-		unsigned long int id = id_system->getUniqueId();
-		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, dialogue_event_instance));
-
-		dialogue_event_instance->setCallback(dialogueEventCallback,
-											 FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND |
-											 FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND |
-											 FMOD_STUDIO_EVENT_CALLBACK_STOPPED |
-											 FMOD_STUDIO_EVENT_CALLBACK_DESTROYED);
-
-		DialogueUserData* dialogue_user_data = new DialogueUserData();
-		dialogue_user_data->is_3d = true;
-		dialogue_user_data->line_key = key;
-		dialogue_user_data->associated_event_id = id;
-		audio_engine->m_alloc_dialogue_user_data.insert(std::pair<unsigned long int, DialogueUserData*>(id, dialogue_user_data));
-
-		e = errorCheck(dialogue_event_instance->setUserData(dialogue_user_data));
-		if (e == 1) 
-		{
-			audio_engine->m_alloc_dialogue_user_data.erase(id);
-			delete dialogue_user_data;
-			dialogue_user_data = nullptr;
-			return 0; 
-		}
-
-		e = errorCheck(dialogue_event_instance->start());
-		if (e == 1) 
-		{
-			audio_engine->m_alloc_dialogue_user_data.erase(id);
-			delete dialogue_user_data;
-			dialogue_user_data = nullptr;
-			return 0; 
-		}
-
-		return id;
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-unsigned long int FmodWrapper::playDialogue2D(const std::string key, DialogueMasterEvents master_event, std::map<std::string, float> parameters)
-{	
-	if (!audio_engine_initialized) { return 0; }
-
-	std::string dialogue_master_event;
-
-	switch (master_event)
-	{
-	case PC:
-		dialogue_master_event = "event:/PC_Dialogue_Master";
-		break;
-	case NPC:
-		dialogue_master_event = "event:/NPC_Dialogue_Master";
-		break;
-	default:
-		return 0;
-	}
-
-	FMOD::Studio::EventDescription* dialogue_event_description = nullptr;
-	int e = errorCheck(audio_engine->studio_system->getEvent(dialogue_master_event.c_str(), &dialogue_event_description));
-	if (e == 1) { return 0; }
-
-	FMOD::Studio::EventInstance* dialogue_event_instance = nullptr;
-	e = errorCheck(dialogue_event_description->createInstance(&dialogue_event_instance));
-	if (e == 1) { return 0; }
-
-	if (!parameters.empty())
-	{
-		for (auto it = parameters.begin(); it != parameters.end(); it++)
-		{
-			std::string parameter = it->first;
-			float value = it->second;
-			errorCheck(dialogue_event_instance->setParameterByName(parameter.c_str(), value, false));
-		}
-	}
-
-	if (id_system != nullptr)
-	{
-		unsigned long int id = id_system->getUniqueId();
-		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, dialogue_event_instance));
-
-		dialogue_event_instance->setCallback(dialogueEventCallback, 
-								             FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND | 
-											 FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND | 
-											 FMOD_STUDIO_EVENT_CALLBACK_STOPPED |
-											 FMOD_STUDIO_EVENT_CALLBACK_DESTROYED);
-
-		DialogueUserData* dialogue_user_data = new DialogueUserData();
-		dialogue_user_data->is_3d = false;
-		dialogue_user_data->line_key = key;
-		dialogue_user_data->associated_event_id = id;
-		audio_engine->m_alloc_dialogue_user_data.insert(std::pair<unsigned long int, DialogueUserData*>(id, dialogue_user_data));
-
-		e = errorCheck(dialogue_event_instance->setUserData(dialogue_user_data));
-		if (e == 1)
-		{
-			audio_engine->m_alloc_dialogue_user_data.erase(id);
-			delete dialogue_user_data;
-			dialogue_user_data = nullptr;
-			return 0;
-		}
-
-		e = errorCheck(dialogue_event_instance->start());
-		if (e == 1)
-		{
-			audio_engine->m_alloc_dialogue_user_data.erase(id);
-			delete dialogue_user_data;
-			dialogue_user_data = nullptr;
-			return 0;
-		}
-		return id;
-	}
-	else
-	{
-		return 0;
-	}	
-}
-
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include "fmod_wrapper.h"
+#include "call_recorder.h"
+
+WrapperImplementation* audio_engine = nullptr;
+IdSystem* id_system = nullptr;
+CallRecorder* call_recorder = nullptr;
+
+bool FmodWrapper::audio_engine_initialized = false;
+std::map<std::string, float> FmodWrapper::empty_map;
+
+// Reads a whole bank file on a background thread. The thread shares the buffer with the caller, so it can outlive a cancelled
+// read or the audio engine itself.
+static std::shared_ptr<BankFileRead> readBankFileAsync(const std::string& path)
+{
+	std::shared_ptr<BankFileRead> read = std::make_shared<BankFileRead>();
+
+	std::thread([read, path]()
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		std::streamsize size = file.is_open() ? (std::streamsize)file.tellg() : 0;
+		if (size <= 0)
+		{
+			read->status.store(BankFileRead::read_failed, std::memory_order_release);
+			return;
+		}
+
+		read->data.resize((size_t)size);
+		file.seekg(0, std::ios::beg);
+		bool ok = (bool)file.read(read->data.data(), size);
+		read->status.store(ok ? BankFileRead::read_done : BankFileRead::read_failed, std::memory_order_release);
+	}).detach();
+
+	return read;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Plenty for the instances destroyed between two updates. If it ever fills up, the next updates sweep for the user data of destroyed instances.
+static const size_t released_user_data_capacity = 1024;
+
+WrapperImplementation::WrapperImplementation(const AudioEngineSettings& settings) : m_released_user_data(released_user_data_capacity)
+{
+	m_startup_time = std::chrono::steady_clock::now();
+
+	studio_system = nullptr;
+	FmodWrapper::errorCheck(FMOD::Studio::System::create(&studio_system));
+	core_system = nullptr;
+	FmodWrapper::errorCheck(studio_system->getCoreSystem(&core_system));
+
+	if (settings.non_realtime_output)
+	{
+		// Has to be set before the system is initialized.
+		FmodWrapper::errorCheck(core_system->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT));
+	}
+
+	// Applies to every stream opened afterwards, bank streams included, and bounds the file buffers of the dialogue stream pool.
+	FmodWrapper::errorCheck(core_system->setStreamBufferSize(settings.dialogue_sounds.stream_file_buffer_bytes, FMOD_TIMEUNIT_RAWBYTES));
+	m_startup_report.create_ms = millisecondsSince(m_startup_time);
+
+	auto initialize_start = std::chrono::steady_clock::now();
+	FmodWrapper::errorCheck(studio_system->initialize(1024, FMOD_STUDIO_INIT_NORMAL, FMOD_INIT_NORMAL, NULL));
+	core_system->setSoftwareFormat(0, FMOD_SPEAKERMODE_STEREO, 0);
+	m_startup_report.initialize_ms = millisecondsSince(initialize_start);
+
+	m_master_channel_group = nullptr;
+	FmodWrapper::errorCheck(core_system->getMasterChannelGroup(&m_master_channel_group));
+	m_mix_clock = 0;
+	m_released_user_data_overflows = 0;
+	m_unswept_user_data = 0;
+
+	m_sample_rate = 48000;
+	FmodWrapper::errorCheck(core_system->getSoftwareFormat(&m_sample_rate, nullptr, nullptr));
+	m_beat_subscriber = 0;
+	m_schedule_lookahead = 0.1f;
+
+	m_num_listeners = 0;
+	for (int i = 0; i < FMOD_MAX_LISTENERS; i++)
+	{
+		m_listeners[i].position = { 0.0f, 0.0f, 0.0f };
+		m_listeners[i].velocity = { 0.0f, 0.0f, 0.0f };
+		m_listeners[i].forward = { 0.0f, 0.0f, 1.0f };
+		m_listeners[i].up = { 0.0f, 1.0f, 0.0f };
+		m_listener_weights[i] = 1.0f;
+	}
+	m_num_active_listeners = 0;
+
+	m_last_update_time = std::chrono::steady_clock::now();
+	m_delta_time = 0.0f;
+
+	m_lazy_loading_enabled = false;
+	m_lazy_loading_timeout = 2.0f;
+	m_restore_budget = 32;
+
+	m_dialogue_sound_settings = settings.dialogue_sounds;
+	if (m_dialogue_sound_settings.max_streams < 0) { m_dialogue_sound_settings.max_streams = 0; }
+	m_open_dialogue_streams = 0;
+	m_peak_dialogue_streams = 0;
+	m_dialogue_streams_opened = 0;
+	m_dialogue_samples_created = 0;
+	m_dialogue_stream_fallbacks = 0;
+	m_dialogue_sample_bytes = 0;
+	m_peak_dialogue_sample_bytes = 0;
+
+	m_voiceover_generation = 0;
+	for (int i = 0; i < max_voiceover_generations; i++)
+	{
+		m_voiceover_lines[i] = 0;
+	}
+	m_voiceover_draining = false;
+
+	m_coalescing_enabled = true;
+	m_parameter_epsilon = 0.0f;
+	m_movement_threshold = 0.0f;
+}
+
+WrapperImplementation::~WrapperImplementation()
+{
+	FmodWrapper::errorCheck(studio_system->unloadAll());
+	FmodWrapper::errorCheck(studio_system->release());
+
+	if (!m_alloc_dialogue_user_data.empty())
+	{
+		for (auto it = m_alloc_dialogue_user_data.begin(); it != m_alloc_dialogue_user_data.end(); ++it)
+		{
+			if (it->second != nullptr)
+			{
+				DialogueUserData* data = it->second;
+				delete data;
+				it->second = nullptr;
+			}
+		}
+		m_alloc_dialogue_user_data.clear();
+	}
+
+	// The studio system has been released, so FMOD's thread no longer refers to these.
+	for (auto it = m_event_callback_data.begin(); it != m_event_callback_data.end(); ++it)
+	{
+		delete it->second;
+	}
+	m_event_callback_data.clear();
+
+	for (auto it = m_callback_subscribers.begin(); it != m_callback_subscribers.end(); ++it)
+	{
+		delete it->second;
+	}
+	m_callback_subscribers.clear();
+}
+
+void WrapperImplementation::eraseEvent(std::map<unsigned long int, FMOD::Studio::EventInstance*>::iterator& it)
+{
+	std::cout << "Erased ID: " << it->first << std::endl; // Temp debug print.
+	m_emitter_registry.remove(it->first);
+	m_level_meters.remove(it->first);
+	m_occlusion.remove(it->first);
+	m_staged_writes.erase(it->first);
+	m_scheduled_start_clocks.erase(it->first);
+	m_reference_beats.erase(it->first);
+	m_events.erase(it++);
+}
+
+void WrapperImplementation::runUpdate()
+{
+	auto now = std::chrono::steady_clock::now();
+	m_delta_time = std::chrono::duration<float>(now - m_last_update_time).count();
+	m_last_update_time = now;
+
+	dispatchEventCallbacks();
+	freeReleasedUserData();
+
+	if (!m_events.empty())
+	{
+		for (auto it = m_events.begin(); it != m_events.end();)
+		{
+			bool event_valid = it->second->isValid();
+
+			if (event_valid == false) 
+			{
+				eraseEvent(it);
+				continue;
+			}
+
+			FMOD_STUDIO_PLAYBACK_STATE pb_state;
+			it->second->getPlaybackState(&pb_state);
+
+			if (pb_state == FMOD_STUDIO_PLAYBACK_STOPPED)
+			{
+				FmodWrapper::errorCheck(it->second->release());
+				eraseEvent(it);
+				continue;
+			}
+
+			++it;
+		}
+	}
+
+	updateStartupLoads();
+	updateBankReloads();
+	updateVoiceoverLocale();
+	updatePendingBankLoads();
+	updateDeferredPlays();
+	updateScheduledPlays();
+	updateMixerFades();
+	updateSnapshots();
+	flushStagedWrites();
+	gatherActiveListeners();
+	updateStreamingZones();
+	m_emitter_registry.update(m_active_listeners, m_num_active_listeners, m_delta_time);
+	m_emitter_clusters.update(studio_system);
+	m_occlusion.update(m_active_listeners, m_num_active_listeners, m_delta_time);
+	m_level_meters.update(m_delta_time);
+
+	// Sampled here once per update, so that FMOD's thread doesn't have to query the mixer for every callback it publishes.
+	unsigned long long mix_clock = 0;
+	if (m_master_channel_group != nullptr && m_master_channel_group->getDSPClock(&mix_clock, nullptr) == FMOD_OK)
+	{
+		m_mix_clock.store(mix_clock, std::memory_order_relaxed);
+	}
+	studio_system->update();
+}
+
+FMOD::Studio::Bus* WrapperImplementation::getBus(const std::string& bus)
+{
+	auto find_key = m_buses.find(bus);
+
+	if (find_key != m_buses.end())
+	{
+		if (find_key->second->isValid()) { return find_key->second; }
+		m_buses.erase(find_key);
+	}
+
+	FMOD::Studio::Bus* b = nullptr;
+	int e = FmodWrapper::errorCheck(studio_system->getBus(bus.c_str(), &b));
+	if (e == 1 || b == nullptr || !b->isValid()) { return nullptr; }
+
+	m_buses[bus] = b;
+	return b;
+}
+
+FMOD::Studio::VCA* WrapperImplementation::getVCA(const std::string& vca)
+{
+	auto find_key = m_vcas.find(vca);
+
+	if (find_key != m_vcas.end())
+	{
+		if (find_key->second->isValid()) { return find_key->second; }
+		m_vcas.erase(find_key);
+	}
+
+	FMOD::Studio::VCA* v = nullptr;
+	int e = FmodWrapper::errorCheck(studio_system->getVCA(vca.c_str(), &v));
+	if (e == 1 || v == nullptr || !v->isValid()) { return nullptr; }
+
+	m_vcas[vca] = v;
+	return v;
+}
+
+void WrapperImplementation::cacheMixerHandles(FMOD::Studio::Bank* bank)
+{
+	// Paths can only be retrieved when the strings bank is loaded. Handles that can't be prefetched here are resolved on first use instead.
+	char path[512];
+	int retrieved = 0;
+	int count = 0;
+
+	if (bank->getBusCount(&count) == FMOD_OK && count > 0)
+	{
+		std::vector<FMOD::Studio::Bus*> buses(count);
+		bank->getBusList(buses.data(), count, &count);
+		for (int i = 0; i < count; i++)
+		{
+			if (buses[i]->getPath(path, sizeof(path), &retrieved) == FMOD_OK) { m_buses[path] = buses[i]; }
+		}
+	}
+
+	count = 0;
+	if (bank->getVCACount(&count) == FMOD_OK && count > 0)
+	{
+		std::vector<FMOD::Studio::VCA*> vcas(count);
+		bank->getVCAList(vcas.data(), count, &count);
+		for (int i = 0; i < count; i++)
+		{
+			if (vcas[i]->getPath(path, sizeof(path), &retrieved) == FMOD_OK) { m_vcas[path] = vcas[i]; }
+		}
+	}
+}
+
+void WrapperImplementation::cancelMixerFade(FMOD::Studio::Bus* bus, FMOD::Studio::VCA* vca)
+{
+	for (size_t i = 0; i < m_mixer_fades.size(); i++)
+	{
+		if (m_mixer_fades[i].bus == bus && m_mixer_fades[i].vca == vca)
+		{
+			m_mixer_fades[i] = m_mixer_fades.back();
+			m_mixer_fades.pop_back();
+			return;
+		}
+	}
+}
+
+void WrapperImplementation::startMixerFade(FMOD::Studio::Bus* bus, FMOD::Studio::VCA* vca, float start_volume, float target_volume, float fade_seconds)
+{
+	// A new fade on the same bus / VCA replaces the one in progress, starting from the current volume.
+	cancelMixerFade(bus, vca);
+
+	MixerFade fade;
+	fade.bus = bus;
+	fade.vca = vca;
+	fade.start_volume = start_volume;
+	fade.target_volume = target_volume;
+	fade.duration = fade_seconds;
+	fade.elapsed = 0.0f;
+	m_mixer_fades.push_back(fade);
+}
+
+void WrapperImplementation::updateMixerFades()
+{
+	for (size_t i = 0; i < m_mixer_fades.size();)
+	{
+		MixerFade& fade = m_mixer_fades[i];
+		fade.elapsed += m_delta_time;
+
+		float t = fade.elapsed >= fade.duration ? 1.0f : fade.elapsed / fade.duration;
+		float volume = fade.start_volume + (fade.target_volume - fade.start_volume) * t;
+
+		FMOD_RESULT result = fade.bus != nullptr ? fade.bus->setVolume(volume) : fade.vca->setVolume(volume);
+
+		// Finished, or the handle went invalid together with its bank.
+		if (t >= 1.0f || result != FMOD_OK)
+		{
+			m_mixer_fades[i] = m_mixer_fades.back();
+			m_mixer_fades.pop_back();
+			continue;
+		}
+		++i;
+	}
+}
+
+void WrapperImplementation::retargetSnapshot(ActiveSnapshot& snapshot, float ramp_seconds)
+{
+	if (snapshot.requests.empty()) { return; }
+
+	const SnapshotRequest* top = &snapshot.requests[0];
+	for (size_t i = 1; i < snapshot.requests.size(); i++)
+	{
+		if (snapshot.requests[i].priority >= top->priority) { top = &snapshot.requests[i]; }
+	}
+
+	snapshot.priority = top->priority;
+	snapshot.target_intensity = top->intensity;
+	snapshot.ramp_rate = ramp_seconds > 0.0f ? std::fabs(snapshot.target_intensity - snapshot.current_intensity) / ramp_seconds : 0.0f;
+	snapshot.intensity_dirty = true;
+}
+
+void WrapperImplementation::sortActiveSnapshots()
+{
+	m_active_snapshot_names.clear();
+	for (auto it = m_snapshots.begin(); it != m_snapshots.end(); it++)
+	{
+		if (!it->second.releasing) { m_active_snapshot_names.push_back(it->first); }
+	}
+
+	std::stable_sort(m_active_snapshot_names.begin(), m_active_snapshot_names.end(), [this](const std::string& a, const std::string& b)
+	{
+		return m_snapshots[a].priority > m_snapshots[b].priority;
+	});
+}
+
+int WrapperImplementation::startSnapshotInstance(const std::string& snapshot, ActiveSnapshot& active)
+{
+	FMOD::Studio::EventDescription* snapshot_description = getEventDescription(snapshot);
+	if (snapshot_description == nullptr) { return 0; }
+
+	FMOD::Studio::EventInstance* instance = nullptr;
+	if (FmodWrapper::errorCheck(snapshot_description->createInstance(&instance)) == 1) { return 0; }
+	if (FmodWrapper::errorCheck(instance->start()) == 1)
+	{
+		instance->release();
+		return 0;
+	}
+
+	active.instance = instance;
+	return 1;
+}
+
+void WrapperImplementation::forgetSnapshotRequests(const ActiveSnapshot& snapshot)
+{
+	for (size_t i = 0; i < snapshot.requests.size(); i++)
+	{
+		m_snapshot_requests.erase(snapshot.requests[i].id);
+	}
+}
+
+void WrapperImplementation::updateSnapshots()
+{
+	bool dropped = false;
+
+	for (auto it = m_snapshots.begin(); it != m_snapshots.end();)
+	{
+		ActiveSnapshot& snapshot = it->second;
+
+		// The instance dies when its bank is unloaded or hot reloaded. A reloaded snapshot continues at its current intensity.
+		if (!snapshot.instance->isValid())
+		{
+			snapshot.instance = nullptr;
+			if (snapshot.releasing || startSnapshotInstance(it->first, snapshot) == 0)
+			{
+				forgetSnapshotRequests(snapshot);
+				m_snapshots.erase(it++);
+				dropped = true;
+				continue;
+			}
+			snapshot.intensity_dirty = true;
+		}
+
+		if (snapshot.intensity_dirty)
+		{
+			float difference = snapshot.target_intensity - snapshot.current_intensity;
+			float step = snapshot.ramp_rate * m_delta_time;
+
+			if (snapshot.ramp_rate <= 0.0f || std::fabs(difference) <= step)
+			{
+				snapshot.current_intensity = snapshot.target_intensity;
+				snapshot.intensity_dirty = false;
+			}
+			else
+			{
+				snapshot.current_intensity += difference > 0.0f ? step : -step;
+			}
+
+			FMOD_STUDIO_PARAMETER_ID intensity_id;
+			if (resolveParameterId(snapshot.instance, "Intensity", intensity_id))
+			{
+				FmodWrapper::errorCheck(snapshot.instance->setParameterByID(intensity_id, snapshot.current_intensity));
+			}
+		}
+
+		if (snapshot.releasing && !snapshot.intensity_dirty)
+		{
+			snapshot.instance->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT);
+			snapshot.instance->release();
+			m_snapshots.erase(it++);
+			continue;
+		}
+		++it;
+	}
+
+	if (dropped) { sortActiveSnapshots(); }
+}
+
+FMOD::Studio::Bank* WrapperImplementation::requestBankLoad(const std::string& bank)
+{
+	auto find_key = m_banks.find(bank);
+	if (find_key != m_banks.end()) { return find_key->second; }
+
+	FMOD::Studio::Bank* b = nullptr;
+	int e = FmodWrapper::errorCheck(studio_system->loadBankFile(bank.c_str(), FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &b));
+	if (e == 1) { return nullptr; }
+
+	m_banks[bank] = b;
+	m_pending_bank_loads.push_back(bank);
+	return b;
+}
+
+void WrapperImplementation::updatePendingBankLoads()
+{
+	for (size_t i = 0; i < m_pending_bank_loads.size();)
+	{
+		auto find_key = m_banks.find(m_pending_bank_loads[i]);
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		if (find_key != m_banks.end()) { find_key->second->getLoadingState(&loading_state); }
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+		{
+			++i;
+			continue;
+		}
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED)
+		{
+			cacheMixerHandles(find_key->second);
+			m_manifest.addBank(find_key->first, find_key->second);
+		}
+		else if (find_key != m_banks.end())
+		{
+			// The load failed (or the bank was unloaded meanwhile), forget the handle so that a later load can retry.
+			find_key->second->unload();
+			m_memory_banks.erase(find_key->first);
+			m_banks.erase(find_key);
+		}
+
+		m_pending_bank_loads[i] = m_pending_bank_loads.back();
+		m_pending_bank_loads.pop_back();
+	}
+}
+
+bool WrapperImplementation::deferUntilBankLoaded(const std::string& event, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int& id)
+{
+	id = 0;
+	if (!m_lazy_loading_enabled && m_bank_reloads.empty()) { return false; }
+
+	const std::string* bank = m_manifest.findBank(event);
+	if (bank == nullptr) { return false; }
+
+	auto find_reload = m_bank_reloads.find(*bank);
+	bool swapping = find_reload != m_bank_reloads.end() && find_reload->second.phase != BankReload::reading;
+
+	if (!swapping)
+	{
+		if (!m_lazy_loading_enabled) { return false; }
+
+		auto find_key = m_banks.find(*bank);
+		if (find_key != m_banks.end())
+		{
+			FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+			find_key->second->getLoadingState(&loading_state);
+			if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED) { return false; }
+		}
+		else
+		{
+			if (requestBankLoad(*bank) == nullptr) { return true; }
+			m_lazy_load_stats.on_demand_bank_loads++;
+		}
+	}
+
+	if (id_system == nullptr) { return true; }
+	id = id_system->getUniqueId();
+
+	DeferredPlay& deferred = m_deferred_plays[id];
+	deferred.event = event;
+	deferred.bank = *bank;
+	deferred.is_3d = spatial_attributes != nullptr;
+	if (deferred.is_3d) { deferred.attributes = *spatial_attributes; }
+	deferred.parameters = parameters;
+	deferred.reload_swap = swapping;
+	if (swapping) { m_bank_reload_stats.deferred_plays++; }
+	else { m_lazy_load_stats.deferred_plays++; }
+	return true;
+}
+
+void WrapperImplementation::updateDeferredPlays()
+{
+	int restores_started = 0;
+
+	for (auto it = m_deferred_plays.begin(); it != m_deferred_plays.end();)
+	{
+		DeferredPlay& deferred = it->second;
+		deferred.waited += m_delta_time;
+
+		// The bank is being swapped, the play is started once the new version has loaded.
+		if (m_bank_reloads.find(deferred.bank) != m_bank_reloads.end())
+		{
+			++it;
+			continue;
+		}
+
+		// Restored plays are spread over several updates.
+		if (deferred.restored && restores_started >= m_restore_budget)
+		{
+			++it;
+			continue;
+		}
+
+		// Restored plays whose bank was already loaded (or isn't in the manifest) have no bank to wait for.
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		if (deferred.bank.empty()) { loading_state = FMOD_STUDIO_LOADING_STATE_LOADED; }
+		else
+		{
+			auto find_key = m_banks.find(deferred.bank);
+			if (find_key != m_banks.end()) { find_key->second->getLoadingState(&loading_state); }
+		}
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+		{
+			if (deferred.waited > (deferred.restored ? deferred.restore_timeout : m_lazy_loading_timeout))
+			{
+				if (deferred.restored) { m_audio_state_stats.failed_instances++; }
+				else { m_lazy_load_stats.timeouts++; }
+				discardEventCallbacks(it->first);
+				m_deferred_plays.erase(it++);
+				continue;
+			}
+			++it;
+			continue;
+		}
+
+		FMOD::Studio::EventDescription* event_description = nullptr;
+		FMOD::Studio::EventInstance* event_instance = nullptr;
+		bool is_3d = false;
+
+		if (deferred.restored) { restores_started++; }
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED) { event_description = getEventDescription(deferred.event); }
+		if (event_description != nullptr) { event_description->is3D(&is_3d); }
+
+		if (event_description == nullptr || is_3d != deferred.is_3d || FmodWrapper::errorCheck(event_description->createInstance(&event_instance)) == 1)
+		{
+			if (deferred.restored) { m_audio_state_stats.failed_instances++; }
+			else if (deferred.reload_swap) { m_bank_reload_stats.deferred_plays_failed++; }
+			else { m_lazy_load_stats.failed++; }
+			discardEventCallbacks(it->first);
+			m_deferred_plays.erase(it++);
+			continue;
+		}
+
+		if (deferred.is_3d) { FmodWrapper::errorCheck(event_instance->set3DAttributes(&deferred.attributes)); }
+		for (size_t p = 0; p < deferred.parameter_values.size(); p++)
+		{
+			FmodWrapper::errorCheck(event_instance->setParameterByID(deferred.parameter_values[p].id, deferred.parameter_values[p].value, true));
+		}
+		for (auto p = deferred.parameters.begin(); p != deferred.parameters.end(); p++)
+		{
+			FmodWrapper::errorCheck(event_instance->setParameterByName(p->first.c_str(), p->second, false));
+		}
+		if (deferred.timeline_position > 0) { FmodWrapper::errorCheck(event_instance->setTimelinePosition(deferred.timeline_position)); }
+
+		// Subscriptions made while the play was waiting.
+		attachEventCallbacks(it->first, event_instance);
+
+		if (FmodWrapper::errorCheck(event_instance->start()) == 1)
+		{
+			event_instance->setUserData(nullptr);
+			event_instance->release();
+			discardEventCallbacks(it->first);
+			if (deferred.restored) { m_audio_state_stats.failed_instances++; }
+			else if (deferred.reload_swap) { m_bank_reload_stats.deferred_plays_failed++; }
+			else { m_lazy_load_stats.failed++; }
+		}
+		else if (deferred.restored)
+		{
+			m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(it->first, event_instance));
+			if (deferred.paused) { FmodWrapper::errorCheck(event_instance->setPaused(true)); }
+			if (deferred.register_emitter) { m_emitter_registry.add(it->first, event_instance); }
+			m_audio_state_stats.restored_instances++;
+		}
+		else
+		{
+			m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(it->first, event_instance));
+
+			double latency_ms = deferred.waited * 1000.0;
+			if (deferred.reload_swap)
+			{
+				m_bank_reload_stats.total_deferred_ms += latency_ms;
+				if (latency_ms > m_bank_reload_stats.max_deferred_ms) { m_bank_reload_stats.max_deferred_ms = latency_ms; }
+			}
+			else
+			{
+				m_lazy_load_stats.served++;
+				m_lazy_load_stats.total_latency_ms += latency_ms;
+				if (latency_ms > m_lazy_load_stats.max_latency_ms) { m_lazy_load_stats.max_latency_ms = latency_ms; }
+			}
+		}
+		m_deferred_plays.erase(it++);
+	}
+}
+
+bool WrapperImplementation::acquireDialogueStream()
+{
+	// Called from FMOD's thread. Takes a slot of the stream pool if one is free.
+	int open_streams = m_open_dialogue_streams.load(std::memory_order_relaxed);
+	do
+	{
+		if (open_streams >= m_dialogue_sound_settings.max_streams) { return false; }
+	}
+	while (!m_open_dialogue_streams.compare_exchange_weak(open_streams, open_streams + 1, std::memory_order_relaxed));
+
+	int peak = m_peak_dialogue_streams.load(std::memory_order_relaxed);
+	while (open_streams + 1 > peak && !m_peak_dialogue_streams.compare_exchange_weak(peak, open_streams + 1, std::memory_order_relaxed)) {}
+	return true;
+}
+
+void WrapperImplementation::updateStartupLoads()
+{
+	if (m_startup_report.complete) { return; }
+
+	bool complete = true;
+	for (size_t i = 0; i < m_startup_loads.size(); i++)
+	{
+		StartupBankTiming& timing = m_startup_report.banks[i];
+		FMOD::Studio::Bank* bank = m_startup_loads[i];
+		if (bank == nullptr) { continue; }
+
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		if (timing.metadata_ms == 0.0)
+		{
+			bank->getLoadingState(&loading_state);
+			if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+			{
+				complete = false;
+				continue;
+			}
+			if (loading_state != FMOD_STUDIO_LOADING_STATE_LOADED)
+			{
+				timing.failed = true;
+				m_startup_loads[i] = nullptr;
+				continue;
+			}
+			timing.metadata_ms = millisecondsSince(m_startup_issue_times[i]);
+		}
+
+		if (timing.load_samples)
+		{
+			loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+			bank->getSampleLoadingState(&loading_state);
+			if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+			{
+				complete = false;
+				continue;
+			}
+			if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED) { timing.sample_data_ms = millisecondsSince(m_startup_issue_times[i]); }
+			else { timing.failed = true; }
+		}
+
+		// Done with this bank.
+		m_startup_loads[i] = nullptr;
+	}
+
+	if (complete)
+	{
+		m_startup_report.total_ms = millisecondsSince(m_startup_time);
+		m_startup_report.complete = true;
+		m_startup_loads.clear();
+		m_startup_issue_times.clear();
+	}
+}
+
+void WrapperImplementation::abandonStartupLoads()
+{
+	if (m_startup_report.complete) { return; }
+
+	// The banks stay in the pending loads, so one that finishes later is still set up by the update.
+	for (size_t i = 0; i < m_startup_loads.size(); i++)
+	{
+		if (m_startup_loads[i] != nullptr) { m_startup_report.banks[i].failed = true; }
+	}
+
+	m_startup_report.total_ms = millisecondsSince(m_startup_time);
+	m_startup_report.complete = true;
+	m_startup_report.timed_out = true;
+	m_startup_loads.clear();
+	m_startup_issue_times.clear();
+}
+
+unsigned long long WrapperImplementation::referenceStartClock(unsigned long int reference_id)
+{
+	auto find_start = m_scheduled_start_clocks.find(reference_id);
+	if (find_start != m_scheduled_start_clocks.end()) { return find_start->second; }
+
+	auto find_scheduled = m_scheduled_plays.find(reference_id);
+	if (find_scheduled != m_scheduled_plays.end()) { return find_scheduled->second.dsp_clock; }
+
+	auto find_event = m_events.find(reference_id);
+	if (find_event == m_events.end()) { return 0; }
+
+	// Estimated: the timeline position is only as exact as the last studio update.
+	int timeline_position = 0;
+	unsigned long long now = 0;
+	if (find_event->second->getTimelinePosition(&timeline_position) != FMOD_OK) { return 0; }
+	if (m_master_channel_group->getDSPClock(&now, nullptr) != FMOD_OK) { return 0; }
+
+	unsigned long long elapsed = (unsigned long long)timeline_position * m_sample_rate / 1000;
+	return now > elapsed ? now - elapsed : 1;
+}
+
+bool WrapperImplementation::resolveBeatPlay(ScheduledPlay& play, unsigned long long now)
+{
+	auto find_beat = m_reference_beats.find(play.reference_id);
+	if (find_beat == m_reference_beats.end() || find_beat->second.tempo <= 0.0f) { return false; }
+
+	const ReferenceBeat& beat = find_beat->second;
+	double samples_per_beat = 60.0 / beat.tempo * m_sample_rate;
+	int beats_per_bar = beat.time_signature_upper > 0 ? beat.time_signature_upper : 4;
+	unsigned long long earliest = now + (unsigned long long)(m_schedule_lookahead * m_sample_rate);
+
+	// First beat at or after the earliest time the play can still be issued on.
+	long long n = 0;
+	if (earliest > beat.dsp_clock) { n = (long long)std::ceil((double)(earliest - beat.dsp_clock) / samples_per_beat); }
+
+	if (play.on_bar)
+	{
+		// "beat" is 1-based within its bar.
+		long long beat_in_bar = (beat.beat - 1 + n) % beats_per_bar;
+		if (beat_in_bar != 0) { n += beats_per_bar - beat_in_bar; }
+		n += (long long)play.extra * beats_per_bar;
+	}
+	else
+	{
+		n += play.extra;
+	}
+
+	play.dsp_clock = beat.dsp_clock + (unsigned long long)std::llround(n * samples_per_beat);
+	return true;
+}
+
+void WrapperImplementation::updateScheduledPlays()
+{
+	if (m_scheduled_plays.empty()) { return; }
+
+	unsigned long long now = 0;
+	if (FmodWrapper::errorCheck(m_master_channel_group->getDSPClock(&now, nullptr)) == 1) { return; }
+
+	// 1. Beat aligned plays get their time once their reference has reported a beat.
+	for (auto it = m_scheduled_plays.begin(); it != m_scheduled_plays.end();)
+	{
+		ScheduledPlay& play = it->second;
+		if (play.dsp_clock != 0 || play.reference_id == 0)
+		{
+			++it;
+			continue;
+		}
+
+		if (m_events.find(play.reference_id) == m_events.end() && m_scheduled_plays.find(play.reference_id) == m_scheduled_plays.end())
+		{
+			// The reference ended before reporting a beat.
+			m_schedule_stats.failed++;
+			discardEventCallbacks(it->first);
+			m_scheduled_plays.erase(it++);
+			continue;
+		}
+
+		if (resolveBeatPlay(play, now)) { m_schedule.insert(std::pair<unsigned long long, unsigned long int>(play.dsp_clock, it->first)); }
+		++it;
+	}
+
+	// 2. Start everything due within the lookahead. The instances are created paused, so that nothing is heard before the start delay is in place.
+	unsigned long long horizon = now + (unsigned long long)(m_schedule_lookahead * m_sample_rate);
+	std::vector<std::pair<unsigned long int, FMOD::Studio::EventInstance*>> issued;
+
+	while (!m_schedule.empty() && m_schedule.begin()->first <= horizon)
+	{
+		unsigned long int id = m_schedule.begin()->second;
+		m_schedule.erase(m_schedule.begin());
+
+		auto find_play = m_scheduled_plays.find(id);
+		if (find_play == m_scheduled_plays.end()) { continue; } // Cancelled.
+		ScheduledPlay& play = find_play->second;
+
+		FMOD::Studio::EventDescription* event_description = getEventDescription(play.event);
+		FMOD::Studio::EventInstance* event_instance = nullptr;
+		if (event_description == nullptr || FmodWrapper::errorCheck(event_description->createInstance(&event_instance)) == 1)
+		{
+			m_schedule_stats.failed++;
+			discardEventCallbacks(id);
+			m_scheduled_plays.erase(find_play);
+			continue;
+		}
+
+		if (play.is_3d) { FmodWrapper::errorCheck(event_instance->set3DAttributes(&play.attributes)); }
+		for (auto p = play.parameters.begin(); p != play.parameters.end(); p++)
+		{
+			FmodWrapper::errorCheck(event_instance->setParameterByName(p->first.c_str(), p->second, false));
+		}
+
+		attachEventCallbacks(id, event_instance);
+		FmodWrapper::errorCheck(event_instance->setPaused(true));
+
+		if (FmodWrapper::errorCheck(event_instance->start()) == 1)
+		{
+			// Detach the user data first, the DESTROYED callback of the released instance must not see it once it's freed.
+			event_instance->setUserData(nullptr);
+			event_instance->release();
+			m_schedule_stats.failed++;
+			discardEventCallbacks(id);
+			m_scheduled_plays.erase(find_play);
+			continue;
+		}
+
+		m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
+		issued.push_back(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
+	}
+
+	if (issued.empty()) { return; }
+
+	// The event channel groups only exist once the studio thread has processed the starts. One flush for the whole batch.
+	FmodWrapper::errorCheck(studio_system->flushCommands());
+
+	for (size_t i = 0; i < issued.size(); i++)
+	{
+		unsigned long int id = issued[i].first;
+		FMOD::Studio::EventInstance* event_instance = issued[i].second;
+		unsigned long long target = m_scheduled_plays[id].dsp_clock;
+		m_scheduled_plays.erase(id);
+
+		// The delay is given in the parent's clock. Sample the master clock again, the flush took time.
+		FMOD::ChannelGroup* channel_group = nullptr;
+		unsigned long long parent_clock = 0;
+		unsigned long long master_clock = 0;
+		if (FmodWrapper::errorCheck(event_instance->getChannelGroup(&channel_group)) == 1 ||
+			FmodWrapper::errorCheck(channel_group->getDSPClock(nullptr, &parent_clock)) == 1 ||
+			FmodWrapper::errorCheck(m_master_channel_group->getDSPClock(&master_clock, nullptr)) == 1)
+		{
+			// Plays right away instead.
+			event_instance->setPaused(false);
+			m_schedule_stats.failed++;
+			continue;
+		}
+
+		long long lead = (long long)target - (long long)master_clock;
+		if (lead > 0) { FmodWrapper::errorCheck(channel_group->setDelay(parent_clock + (unsigned long long)lead, 0, false)); }
+		FmodWrapper::errorCheck(event_instance->setPaused(false));
+
+		m_scheduled_start_clocks[id] = lead > 0 ? target : master_clock;
+		m_schedule_stats.started++;
+
+		double lead_ms = (double)lead * 1000.0 / m_sample_rate;
+		if (lead <= 0)
+		{
+			m_schedule_stats.late++;
+			m_schedule_stats.total_error_ms -= lead_ms;
+			if (-lead_ms > m_schedule_stats.max_error_ms) { m_schedule_stats.max_error_ms = -lead_ms; }
+		}
+		m_schedule_stats.total_lead_ms += lead_ms;
+		if (m_schedule_stats.started == 1 || lead_ms < m_schedule_stats.min_lead_ms) { m_schedule_stats.min_lead_ms = lead_ms; }
+	}
+}
+
+void WrapperImplementation::updateVoiceoverLocale()
+{
+	bool switching = m_voiceover_switch.bank_handle != nullptr;
+	if (switching || m_voiceover_draining)
+	{
+		int current_bytes = 0;
+		int max_bytes = 0;
+		FMOD::Memory_GetStats(&current_bytes, &max_bytes, false);
+		if (current_bytes > m_voiceover_stats.peak_switch_memory) { m_voiceover_stats.peak_switch_memory = current_bytes; }
+	}
+
+	if (switching)
+	{
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		m_voiceover_switch.bank_handle->getLoadingState(&loading_state);
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED) { completeVoiceoverLocaleSwitch(); }
+		else if (loading_state != FMOD_STUDIO_LOADING_STATE_LOADING)
+		{
+			// The current locale stays in use.
+			m_voiceover_switch.bank_handle->unload();
+			m_voiceover_switch = VoiceoverLocaleSwitch();
+			m_voiceover_stats.pending_locale.clear();
+			m_voiceover_stats.failed_switches++;
+		}
+	}
+
+	int current = m_voiceover_generation.load(std::memory_order_relaxed) % max_voiceover_generations;
+	m_voiceover_stats.previous_locale_lines = 0;
+	for (int i = 0; i < max_voiceover_generations; i++)
+	{
+		if (i != current) { m_voiceover_stats.previous_locale_lines += m_voiceover_lines[i].load(std::memory_order_relaxed); }
+	}
+
+	if (m_voiceover_draining && m_voiceover_stats.previous_locale_lines == 0)
+	{
+		m_voiceover_stats.last_drain_ms = millisecondsSince(m_voiceover_switch_time);
+		m_voiceover_draining = false;
+	}
+}
+
+void WrapperImplementation::completeVoiceoverLocaleSwitch()
+{
+	// The previous bank is unloaded right away, so that keys can't resolve against both audio tables. Its playing lines
+	// opened their sounds from the bank file, which FMOD keeps open until the last of them is released. This is why locale
+	// banks are never loaded from memory (see "AudioEngineSettings::preread_bank_files").
+	if (!m_voiceover_bank.empty() && m_voiceover_bank != m_voiceover_switch.bank)
+	{
+		auto find_key = m_banks.find(m_voiceover_bank);
+		if (find_key != m_banks.end())
+		{
+			FmodWrapper::errorCheck(find_key->second->unload());
+			m_parameter_ids.clear();
+			m_banks.erase(find_key);
+		}
+	}
+
+	m_banks[m_voiceover_switch.bank] = m_voiceover_switch.bank_handle;
+	m_voiceover_bank = m_voiceover_switch.bank;
+
+	// New lines count against the new generation from here on. A counter is only shared again four switches later,
+	// which at worst blurs the drain statistics.
+	m_voiceover_generation.fetch_add(1, std::memory_order_release);
+	m_voiceover_switch_time = std::chrono::steady_clock::now();
+	m_voiceover_draining = true;
+
+	double switch_ms = millisecondsSince(m_voiceover_switch.start_time);
+	m_voiceover_stats.last_switch_ms = switch_ms;
+	if (switch_ms > m_voiceover_stats.max_switch_ms) { m_voiceover_stats.max_switch_ms = switch_ms; }
+	m_voiceover_stats.locale = m_voiceover_switch.locale;
+	m_voiceover_stats.pending_locale.clear();
+	m_voiceover_stats.switches++;
+
+	m_voiceover_switch = VoiceoverLocaleSwitch();
+}
+
+int WrapperImplementation::bankInstanceCount(FMOD::Studio::Bank* bank)
+{
+	int count = 0;
+	if (bank->getEventCount(&count) != FMOD_OK || count <= 0) { return 0; }
+
+	std::vector<FMOD::Studio::EventDescription*> descriptions(count);
+	bank->getEventList(descriptions.data(), count, &count);
+
+	// Looping events would hold the swap until the timeout every time, so only one-shots are waited for.
+	int instances = 0;
+	for (int i = 0; i < count; i++)
+	{
+		bool oneshot = false;
+		if (descriptions[i]->isOneshot(&oneshot) != FMOD_OK || !oneshot) { continue; }
+
+		int instance_count = 0;
+		if (descriptions[i]->getInstanceCount(&instance_count) == FMOD_OK) { instances += instance_count; }
+	}
+	return instances;
+}
+
+void WrapperImplementation::updateBankReloads()
+{
+	for (auto it = m_bank_reloads.begin(); it != m_bank_reloads.end();)
+	{
+		BankReload& reload = it->second;
+		reload.elapsed += m_delta_time;
+
+		auto find_bank = m_banks.find(it->first);
+		if (find_bank == m_banks.end())
+		{
+			m_bank_reload_stats.failed++;
+			m_bank_reloads.erase(it++);
+			continue;
+		}
+
+		if (reload.phase == BankReload::reading)
+		{
+			int status = reload.read->status.load(std::memory_order_acquire);
+			if (status == BankFileRead::read_pending)
+			{
+				++it;
+				continue;
+			}
+			if (status == BankFileRead::read_failed)
+			{
+				m_bank_reload_stats.failed++;
+				m_bank_reloads.erase(it++);
+				continue;
+			}
+
+			// From here on new plays of the bank are deferred.
+			reload.phase = BankReload::draining;
+			reload.elapsed = 0.0f;
+		}
+
+		if (reload.phase == BankReload::draining)
+		{
+			FMOD::Studio::Bank* old_bank = find_bank->second;
+			int instances = bankInstanceCount(old_bank);
+			if (instances > 0 && reload.elapsed < reload.drain_timeout)
+			{
+				++it;
+				continue;
+			}
+			if (instances > 0) { m_bank_reload_stats.drain_timeouts++; }
+
+			FMOD_STUDIO_LOADING_STATE sample_state = FMOD_STUDIO_LOADING_STATE_UNLOADED;
+			old_bank->getSampleLoadingState(&sample_state);
+			reload.reload_samples = sample_state == FMOD_STUDIO_LOADING_STATE_LOADED || sample_state == FMOD_STUDIO_LOADING_STATE_LOADING;
+
+			// The swap. Descriptions and parameter IDs of the old version are dropped in the same step, so nothing resolves against it afterwards.
+			FmodWrapper::errorCheck(old_bank->unload());
+			m_event_descriptions.clear();
+			m_parameter_ids.clear();
+
+			// FMOD takes a copy of the data, so the read buffer can be released right away.
+			FMOD::Studio::Bank* new_bank = nullptr;
+			int e = FmodWrapper::errorCheck(studio_system->loadBankMemory(reload.read->data.data(), (int)reload.read->data.size(), FMOD_STUDIO_LOAD_MEMORY, FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &new_bank));
+			reload.read.reset();
+
+			if (e == 1)
+			{
+				m_memory_banks.erase(it->first);
+				m_banks.erase(find_bank);
+				m_bank_reload_stats.failed++;
+				m_bank_reloads.erase(it++);
+				continue;
+			}
+
+			// The pending load caches the new mixer handles and updates the manifest once loaded.
+			find_bank->second = new_bank;
+			m_memory_banks.insert(it->first);
+			m_pending_bank_loads.push_back(it->first);
+			reload.phase = BankReload::loading;
+			++it;
+			continue;
+		}
+
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		find_bank->second->getLoadingState(&loading_state);
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+		{
+			++it;
+			continue;
+		}
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED)
+		{
+			if (reload.reload_samples) { FmodWrapper::errorCheck(find_bank->second->loadSampleData()); }
+
+			double reload_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reload.start_time).count();
+			m_bank_reload_stats.completed++;
+			m_bank_reload_stats.total_reload_ms += reload_ms;
+			if (reload_ms > m_bank_reload_stats.max_reload_ms) { m_bank_reload_stats.max_reload_ms = reload_ms; }
+		}
+		else
+		{
+			m_bank_reload_stats.failed++;
+		}
+		m_bank_reloads.erase(it++);
+	}
+}
+
+static float distanceToZone(const StreamingZone& zone, const FMOD_VECTOR& point)
+{
+	float dx = point.x - zone.center.x;
+	float dy = point.y - zone.center.y;
+	float dz = point.z - zone.center.z;
+
+	if (zone.is_sphere)
+	{
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - zone.radius;
+		return distance > 0.0f ? distance : 0.0f;
+	}
+
+	dx = std::fabs(dx) - zone.half_extents.x;
+	dy = std::fabs(dy) - zone.half_extents.y;
+	dz = std::fabs(dz) - zone.half_extents.z;
+	dx = dx > 0.0f ? dx : 0.0f;
+	dy = dy > 0.0f ? dy : 0.0f;
+	dz = dz > 0.0f ? dz : 0.0f;
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+void WrapperImplementation::acquireZoneBanks(StreamingZoneState& state)
+{
+	for (size_t i = 0; i < state.zone.banks.size(); i++)
+	{
+		const std::string& bank = state.zone.banks[i];
+		if (m_zone_bank_refs[bank]++ > 0) { continue; }
+
+		// Metadata first, the sample data load is issued by the update once the metadata is in.
+		if (requestBankLoad(bank) != nullptr) { m_zone_sample_loads.push_back(bank); }
+	}
+	state.prefetched = true;
+	state.resident = false;
+	state.entered = false;
+	m_streaming_zone_stats.prefetches++;
+}
+
+void WrapperImplementation::releaseZoneBanks(StreamingZoneState& state)
+{
+	for (size_t i = 0; i < state.zone.banks.size(); i++)
+	{
+		const std::string& bank = state.zone.banks[i];
+		auto find_ref = m_zone_bank_refs.find(bank);
+		if (find_ref == m_zone_bank_refs.end() || --find_ref->second > 0) { continue; }
+		m_zone_bank_refs.erase(find_ref);
+
+		auto find_pending = std::find(m_zone_sample_loads.begin(), m_zone_sample_loads.end(), bank);
+		if (find_pending != m_zone_sample_loads.end()) { m_zone_sample_loads.erase(find_pending); }
+
+		// Only the sample data is released, the metadata is small and keeps the events resolvable.
+		auto find_bank = m_banks.find(bank);
+		if (find_bank != m_banks.end()) { find_bank->second->unloadSampleData(); }
+	}
+	state.prefetched = false;
+	state.resident = false;
+	m_streaming_zone_stats.releases++;
+}
+
+bool WrapperImplementation::zoneBanksResident(const StreamingZoneState& state)
+{
+	for (size_t i = 0; i < state.zone.banks.size(); i++)
+	{
+		auto find_bank = m_banks.find(state.zone.banks[i]);
+		if (find_bank == m_banks.end()) { return false; }
+
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		find_bank->second->getSampleLoadingState(&loading_state);
+		if (loading_state != FMOD_STUDIO_LOADING_STATE_LOADED) { return false; }
+	}
+	return true;
+}
+
+void WrapperImplementation::updateStreamingZones()
+{
+	if (m_streaming_zones.empty()) { return; }
+
+	// Issue the sample data loads of banks whose metadata has arrived.
+	for (size_t i = 0; i < m_zone_sample_loads.size();)
+	{
+		auto find_bank = m_banks.find(m_zone_sample_loads[i]);
+		FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+		if (find_bank != m_banks.end()) { find_bank->second->getLoadingState(&loading_state); }
+
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADING)
+		{
+			++i;
+			continue;
+		}
+		if (loading_state == FMOD_STUDIO_LOADING_STATE_LOADED)
+		{
+			FmodWrapper::errorCheck(find_bank->second->loadSampleData());
+		}
+		m_zone_sample_loads[i] = m_zone_sample_loads.back();
+		m_zone_sample_loads.pop_back();
+	}
+
+	auto now = std::chrono::steady_clock::now();
+
+	for (auto it = m_streaming_zones.begin(); it != m_streaming_zones.end(); it++)
+	{
+		StreamingZoneState& state = it->second;
+
+		float distance = -1.0f;
+		for (int l = 0; l < m_num_active_listeners; l++)
+		{
+			float d = distanceToZone(state.zone, m_active_listeners[l].position);
+			if (distance < 0.0f || d < distance) { distance = d; }
+		}
+		if (distance < 0.0f) { continue; }
+
+		if (!state.prefetched)
+		{
+			if (distance <= state.zone.prefetch_distance) { acquireZoneBanks(state); }
+			continue;
+		}
+
+		if (distance > state.zone.release_distance)
+		{
+			releaseZoneBanks(state);
+			continue;
+		}
+
+		if (!state.resident && zoneBanksResident(state))
+		{
+			state.resident = true;
+			state.resident_time = now;
+		}
+
+		if (distance <= 0.0f && !state.entered)
+		{
+			state.entered = true;
+
+			if (!state.resident)
+			{
+				m_streaming_zone_stats.late_loads++;
+			}
+			else
+			{
+				double lead_ms = std::chrono::duration<double, std::milli>(now - state.resident_time).count();
+				if (m_streaming_zone_stats.lead_time_samples == 0 || lead_ms < m_streaming_zone_stats.min_lead_time_ms)
+				{
+					m_streaming_zone_stats.min_lead_time_ms = lead_ms;
+				}
+				m_streaming_zone_stats.total_lead_time_ms += lead_ms;
+				m_streaming_zone_stats.lead_time_samples++;
+			}
+		}
+		else if (distance > 0.0f)
+		{
+			state.entered = false;
+		}
+	}
+}
+
+void WrapperImplementation::gatherActiveListeners()
+{
+	m_num_active_listeners = 0;
+	for (int i = 0; i < m_num_listeners; i++)
+	{
+		if (m_listener_weights[i] > 0.0f)
+		{
+			m_active_listeners[m_num_active_listeners++] = m_listeners[i];
+		}
+	}
+}
+
+bool WrapperImplementation::resolveParameterId(FMOD::Studio::EventInstance* instance, const std::string& parameter, FMOD_STUDIO_PARAMETER_ID& id)
+{
+	FMOD::Studio::EventDescription* event_description = nullptr;
+	if (instance->getDescription(&event_description) != FMOD_OK) { return false; }
+
+	std::unordered_map<std::string, FMOD_STUDIO_PARAMETER_ID>& ids = m_parameter_ids[event_description];
+	auto find_key = ids.find(parameter);
+	if (find_key != ids.end())
+	{
+		id = find_key->second;
+		return true;
+	}
+
+	FMOD_STUDIO_PARAMETER_DESCRIPTION parameter_description;
+	int e = FmodWrapper::errorCheck(event_description->getParameterDescriptionByName(parameter.c_str(), &parameter_description));
+	if (e == 1) { return false; }
+
+	ids[parameter] = parameter_description.id;
+	id = parameter_description.id;
+	return true;
+}
+
+static bool attributesMoved(const FMOD_3D_ATTRIBUTES& a, const FMOD_3D_ATTRIBUTES& b, float threshold)
+{
+	float dx = a.position.x - b.position.x;
+	float dy = a.position.y - b.position.y;
+	float dz = a.position.z - b.position.z;
+	if (dx * dx + dy * dy + dz * dz > threshold * threshold) { return true; }
+
+	// Orientation and velocity changes matter for cones and doppler even when the emitter stays in place.
+	const FMOD_VECTOR* va[3] = { &a.velocity, &a.forward, &a.up };
+	const FMOD_VECTOR* vb[3] = { &b.velocity, &b.forward, &b.up };
+	for (int i = 0; i < 3; i++)
+	{
+		if (std::fabs(va[i]->x - vb[i]->x) > threshold || std::fabs(va[i]->y - vb[i]->y) > threshold || std::fabs(va[i]->z - vb[i]->z) > threshold)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void WrapperImplementation::flushStagedWrites()
+{
+	m_coalescing_stats.flushed_last_update = 0;
+
+	for (size_t i = 0; i < m_dirty_events.size(); i++)
+	{
+		auto find_key = m_staged_writes.find(m_dirty_events[i]);
+		if (find_key == m_staged_writes.end()) { continue; }
+
+		StagedEventWrites& writes = find_key->second;
+		writes.queued = false;
+
+		if (writes.has_pending_attributes)
+		{
+			writes.has_pending_attributes = false;
+
+			if (writes.has_sent_attributes && !attributesMoved(writes.pending_attributes, writes.sent_attributes, m_movement_threshold))
+			{
+				m_coalescing_stats.skipped++;
+			}
+			else if (FmodWrapper::errorCheck(writes.instance->set3DAttributes(&writes.pending_attributes)) == 1)
+			{
+				m_coalescing_stats.failed++;
+			}
+			else
+			{
+				writes.sent_attributes = writes.pending_attributes;
+				writes.has_sent_attributes = true;
+				m_coalescing_stats.flushed_last_update++;
+			}
+		}
+
+		for (size_t p = 0; p < writes.parameters.size(); p++)
+		{
+			StagedParameter& parameter = writes.parameters[p];
+			if (!parameter.has_pending) { continue; }
+			parameter.has_pending = false;
+
+			if (parameter.has_sent && std::fabs(parameter.pending_value - parameter.sent_value) <= m_parameter_epsilon)
+			{
+				m_coalescing_stats.skipped++;
+				continue;
+			}
+
+			if (FmodWrapper::errorCheck(writes.instance->setParameterByID(parameter.id, parameter.pending_value)) == 1)
+			{
+				m_coalescing_stats.failed++;
+				continue;
+			}
+			parameter.sent_value = parameter.pending_value;
+			parameter.has_sent = true;
+			m_coalescing_stats.flushed_last_update++;
+		}
+	}
+
+	m_coalescing_stats.flushed += m_coalescing_stats.flushed_last_update;
+	m_dirty_events.clear();
+}
+
+void WrapperImplementation::dispatchEventCallbacks()
+{
+	// A handler may create new subscribers, which doesn't invalidate the iterator of a std::map.
+	for (auto it = m_callback_subscribers.begin(); it != m_callback_subscribers.end(); ++it)
+	{
+		CallbackSubscriber* subscriber = it->second;
+		EventCallbackMessage message;
+		while (subscriber->ring.pop(message))
+		{
+			if (subscriber->active.load(std::memory_order_relaxed)) { subscriber->handler(message, subscriber->user_data); }
+		}
+	}
+}
+
+void WrapperImplementation::freeReleasedUserData()
+{
+	ReleasedUserData released;
+	while (m_released_user_data.pop(released))
+	{
+		// Only free what is still owned by the bookkeeping, a failed play may have already freed its user data.
+		if (released.is_dialogue)
+		{
+			auto find_key = m_alloc_dialogue_user_data.find(released.event_id);
+			if (find_key == m_alloc_dialogue_user_data.end() || find_key->second != released.data) { continue; }
+			delete find_key->second;
+			m_alloc_dialogue_user_data.erase(find_key);
+		}
+		else
+		{
+			auto find_key = m_event_callback_data.find(released.event_id);
+			if (find_key == m_event_callback_data.end() || find_key->second != released.data) { continue; }
+			delete find_key->second;
+			m_event_callback_data.erase(find_key);
+		}
+	}
+
+	// Keep sweeping until as much has been freed as was dropped, an instance may still be finishing its destruction on FMOD's thread.
+	unsigned long int unswept = m_unswept_user_data.load(std::memory_order_acquire);
+	if (unswept == 0) { return; }
+
+	unsigned long int freed = sweepReleasedUserData();
+	m_unswept_user_data.fetch_sub(std::min(freed, unswept), std::memory_order_relaxed);
+}
+
+unsigned long int WrapperImplementation::sweepReleasedUserData()
+{
+	unsigned long int freed = 0;
+
+	// An instance without a handle hasn't been attached yet (a pending deferred or scheduled play).
+	for (auto it = m_alloc_dialogue_user_data.begin(); it != m_alloc_dialogue_user_data.end();)
+	{
+		FMOD::Studio::EventInstance* instance = it->second->callbacks.instance;
+		if (instance == nullptr || instance->isValid()) { ++it; continue; }
+		delete it->second;
+		it = m_alloc_dialogue_user_data.erase(it);
+		freed++;
+	}
+	for (auto it = m_event_callback_data.begin(); it != m_event_callback_data.end();)
+	{
+		FMOD::Studio::EventInstance* instance = it->second->instance;
+		if (instance == nullptr || instance->isValid()) { ++it; continue; }
+		delete it->second;
+		it = m_event_callback_data.erase(it);
+		freed++;
+	}
+	return freed;
+}
+
+void WrapperImplementation::discardEventCallbacks(unsigned long int id)
+{
+	auto find_key = m_event_callback_data.find(id);
+	if (find_key == m_event_callback_data.end()) { return; }
+	delete find_key->second;
+	m_event_callback_data.erase(find_key);
+}
+
+int WrapperImplementation::attachEventCallbacks(unsigned long int id, FMOD::Studio::EventInstance* instance)
+{
+	unsigned int types = 0;
+	EventCallbackData* data = nullptr;
+
+	auto find_dialogue = m_alloc_dialogue_user_data.find(id);
+	if (find_dialogue != m_alloc_dialogue_user_data.end()) { data = &find_dialogue->second->callbacks; }
+	else
+	{
+		auto find_key = m_event_callback_data.find(id);
+		if (find_key == m_event_callback_data.end()) { return 1; }
+		data = find_key->second;
+	}
+
+	int count = data->count.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; i++)
+	{
+		types |= data->types[i].load(std::memory_order_relaxed);
+	}
+
+	int e;
+	if (find_dialogue != m_alloc_dialogue_user_data.end())
+	{
+		// The dialogue callback forwards the subscribed types after doing its own work.
+		e = FmodWrapper::errorCheck(instance->setCallback(FmodWrapper::dialogueEventCallback,
+														  types |
+														  FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND |
+														  FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND |
+														  FMOD_STUDIO_EVENT_CALLBACK_STOPPED |
+														  FMOD_STUDIO_EVENT_CALLBACK_DESTROYED));
+		if (e == 1) { return 0; }
+		return 1;
+	}
+
+	e = FmodWrapper::errorCheck(instance->setUserData(data));
+	if (e == 1) { return 0; }
+	data->instance = instance;
+	e = FmodWrapper::errorCheck(instance->setCallback(FmodWrapper::eventCallbackRouter, types | FMOD_STUDIO_EVENT_CALLBACK_DESTROYED));
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+// Runs on FMOD's thread: copies the callback into the rings of its subscribers without allocating or locking.
+// All studio callbacks come from the same thread, so each ring has a single producer.
+static void publishEventCallback(EventCallbackData* data, FMOD_STUDIO_EVENT_CALLBACK_TYPE type, void* parameter, unsigned long long mix_clock)
+{
+	int count = data->count.load(std::memory_order_acquire);
+	if (count == 0) { return; }
+
+	bool subscribed = false;
+	for (int i = 0; i < count; i++)
+	{
+		if ((data->types[i].load(std::memory_order_relaxed) & type) != 0) { subscribed = true; }
+	}
+	if (!subscribed) { return; }
+
+	EventCallbackMessage message;
+	message.event_id = data->event_id;
+	message.type = type;
+	message.dsp_clock = mix_clock;
+
+	if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_MARKER && parameter != nullptr)
+	{
+		FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES* marker = (FMOD_STUDIO_TIMELINE_MARKER_PROPERTIES*)parameter;
+		message.position = marker->position;
+		if (marker->name != nullptr)
+		{
+			size_t i = 0;
+			for (; i < sizeof(message.marker_name) - 1 && marker->name[i] != '\0'; i++) { message.marker_name[i] = marker->name[i]; }
+			message.marker_name[i] = '\0';
+		}
+	}
+	else if (type == FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT && parameter != nullptr)
+	{
+		FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES* beat = (FMOD_STUDIO_TIMELINE_BEAT_PROPERTIES*)parameter;
+		message.position = beat->position;
+		message.bar = beat->bar;
+		message.beat = beat->beat;
+		message.tempo = beat->tempo;
+		message.time_signature_upper = beat->timesignatureupper;
+		message.time_signature_lower = beat->timesignaturelower;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if ((data->types[i].load(std::memory_order_relaxed) & type) == 0) { continue; }
+
+		CallbackSubscriber* subscriber = data->subscribers[i];
+		if (!subscriber->active.load(std::memory_order_relaxed)) { continue; }
+		if (!subscriber->ring.push(message)) { subscriber->dropped.fetch_add(1, std::memory_order_relaxed); }
+	}
+}
+
+FMOD::Studio::EventDescription* WrapperImplementation::getEventDescription(const std::string& event)
+{
+	auto find_key = m_event_descriptions.find(event);
+
+	if (find_key != m_event_descriptions.end())
+	{
+		// Descriptions turn invalid when the bank holding them is unloaded.
+		if (find_key->second->isValid()) { return find_key->second; }
+		m_event_descriptions.erase(find_key);
+	}
+
+	FMOD::Studio::EventDescription* event_description = nullptr;
+	int e = FmodWrapper::errorCheck(studio_system->getEvent(event.c_str(), &event_description));
+	if (e == 1) { return nullptr; }
+
+	m_event_descriptions[event] = event_description;
+	return event_description;
+}
+
+
+void FmodWrapper::initializeAudioEngine(const AudioEngineSettings& settings)
+{
+	if (audio_engine_initialized)
+	{
+		// Warn here about trying to initialize multiple audio engines.
+		return;
+	}
+
+	std::vector<StartupBank> startup_banks;
+	StartupBank master_bank;
+	master_bank.file = settings.master_bank;
+	startup_banks.push_back(master_bank);
+	StartupBank master_strings_bank;
+	master_strings_bank.file = settings.master_strings_bank;
+	startup_banks.push_back(master_strings_bank);
+	startup_banks.insert(startup_banks.end(), settings.startup_banks.begin(), settings.startup_banks.end());
+
+	// The file reads overlap with creating and initializing the FMOD system.
+	std::vector<std::shared_ptr<BankFileRead>> reads;
+	if (settings.preread_bank_files)
+	{
+		for (size_t i = 0; i < startup_banks.size(); i++)
+		{
+			reads.push_back(readBankFileAsync(startup_banks[i].file));
+		}
+	}
+
+	audio_engine = new WrapperImplementation(settings);
+	bool engine_is_valid = audio_engine->studio_system->isValid();
+	if (!engine_is_valid) 
+	{
+		// Add game engine console error message here.
+	}
+	else
+	{	
+		initializeIdSystem();
+
+		int e;
+
+		// Issue every load at once. The banks load in parallel on FMOD's loading thread, and sample data loading queued on a bank
+		// that is still loading starts as soon as its metadata is in.
+		auto issue_start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < startup_banks.size(); i++)
+		{
+			const StartupBank& startup_bank = startup_banks[i];
+			if (audio_engine->m_banks.find(startup_bank.file) != audio_engine->m_banks.end()) { continue; }
+
+			FMOD::Studio::Bank* b = nullptr;
+			auto issue_time = std::chrono::steady_clock::now();
+
+			if (!reads.empty())
+			{
+				while (reads[i]->status.load(std::memory_order_acquire) == BankFileRead::read_pending)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+
+			bool from_memory = !reads.empty() && reads[i]->status.load(std::memory_order_acquire) == BankFileRead::read_done;
+			if (from_memory)
+			{
+				e = errorCheck(audio_engine->studio_system->loadBankMemory(reads[i]->data.data(), (int)reads[i]->data.size(), FMOD_STUDIO_LOAD_MEMORY, FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &b));
+				reads[i].reset();
+			}
+			else
+			{
+				e = errorCheck(audio_engine->studio_system->loadBankFile(startup_bank.file.c_str(), FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &b));
+			}
+
+			// Without the master banks there is no mixer, abort initialization. Add error message to the game engine console.
+			if (e == 1 && i < 2) { return; }
+
+			StartupBankTiming timing;
+			timing.file = startup_bank.file;
+			timing.load_samples = startup_bank.load_samples;
+			timing.failed = e == 1;
+			audio_engine->m_startup_report.banks.push_back(timing);
+			audio_engine->m_startup_loads.push_back(e == 1 ? nullptr : b);
+			audio_engine->m_startup_issue_times.push_back(issue_time);
+			if (e == 1) { continue; }
+
+			if (startup_bank.load_samples) { errorCheck(b->loadSampleData()); }
+
+			// The pending load caches the mixer handles and adds the bank to the manifest once loaded.
+			audio_engine->m_banks[startup_bank.file] = b;
+			audio_engine->m_pending_bank_loads.push_back(startup_bank.file);
+			if (from_memory) { audio_engine->m_memory_banks.insert(startup_bank.file); }
+		}
+		audio_engine->m_startup_report.issue_loads_ms = millisecondsSince(issue_start);
+
+		e = setNumberOfListeners(settings.num_listeners);
+		// If setting up listeners failed, abort initialization. Add error message to the game engine console.
+		if (e == 0) { return; }
+
+		// Setting up some default listener 3D attributes for debugging purposes in the absence of an available game engine. Remove when doing a real integration!
+		for (int i = 0; i < settings.num_listeners; i++)
+		{
+			errorCheck(audio_engine->studio_system->setListenerAttributes(i, &audio_engine->m_listeners[i]));
+		}
+
+		audio_engine_initialized = true;
+		std::cout << "Audio engine initialized!\n" << std::endl; // Temp debug print.
+
+		auto update_start = std::chrono::steady_clock::now();
+		audio_engine->runUpdate();
+		audio_engine->m_startup_report.first_update_ms = millisecondsSince(update_start);
+
+		if (settings.wait_for_startup_banks)
+		{
+			// Studio only hands queued commands to its loading thread and picks up their results during an update, so keep updating while waiting.
+			auto wait_start = std::chrono::steady_clock::now();
+			while (!audio_engine->m_startup_report.complete)
+			{
+				if (millisecondsSince(wait_start) > settings.startup_wait_timeout * 1000.0)
+				{
+					audio_engine->abandonStartupLoads();
+					break;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				errorCheck(audio_engine->studio_system->update());
+				audio_engine->updateStartupLoads();
+			}
+			audio_engine->m_startup_report.wait_ms = millisecondsSince(wait_start);
+
+			// Mixer handles and manifest entries of the now loaded banks.
+			audio_engine->updatePendingBankLoads();
+		}
+	}
+}
+
+WrapperDiagnostics FmodWrapper::getDiagnostics()
+{
+	WrapperDiagnostics diagnostics;
+	if (!audio_engine_initialized) { return diagnostics; }
+
+	diagnostics.events = (unsigned long int)audio_engine->m_events.size();
+	diagnostics.dialogue_user_data = (unsigned long int)audio_engine->m_alloc_dialogue_user_data.size();
+	diagnostics.event_callback_data = (unsigned long int)audio_engine->m_event_callback_data.size();
+	diagnostics.deferred_plays = (unsigned long int)audio_engine->m_deferred_plays.size();
+	diagnostics.staged_writes = (unsigned long int)audio_engine->m_staged_writes.size();
+	diagnostics.dirty_events = (unsigned long int)audio_engine->m_dirty_events.size();
+	diagnostics.mixer_fades = (unsigned long int)audio_engine->m_mixer_fades.size();
+	diagnostics.snapshots = (unsigned long int)audio_engine->m_snapshots.size();
+	diagnostics.snapshot_requests = (unsigned long int)audio_engine->m_snapshot_requests.size();
+	diagnostics.emitters = audio_engine->m_emitter_registry.getStats().emitters;
+	diagnostics.meters = (unsigned long int)audio_engine->m_level_meters.size();
+	diagnostics.occlusion_emitters = audio_engine->m_occlusion.getStats().emitters;
+	diagnostics.banks = (unsigned long int)audio_engine->m_banks.size();
+	diagnostics.pending_bank_loads = (unsigned long int)audio_engine->m_pending_bank_loads.size();
+	diagnostics.bank_reloads = (unsigned long int)audio_engine->m_bank_reloads.size();
+	diagnostics.event_descriptions = (unsigned long int)audio_engine->m_event_descriptions.size();
+	diagnostics.scheduled_plays = (unsigned long int)audio_engine->m_scheduled_plays.size();
+	diagnostics.released_user_data_overflows = audio_engine->m_released_user_data_overflows.load(std::memory_order_relaxed);
+	diagnostics.clustered_emitters = audio_engine->m_emitter_clusters.getStats().emitters;
+	return diagnostics;
+}
+
+int FmodWrapper::loadStartupManifest(const std::string& file_path, AudioEngineSettings& settings)
+{
+	std::ifstream file(file_path.c_str(), std::ios::in);
+	if (!file.is_open()) { return 0; }
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!line.empty() && line[line.size() - 1] == '\r') { line.erase(line.size() - 1); }
+		if (line.empty() || line[0] == '#') { continue; }
+
+		StartupBank bank;
+		size_t separator = line.find('\t');
+		bank.file = line.substr(0, separator);
+		bank.load_samples = separator != std::string::npos && line.substr(separator + 1) == "samples";
+		settings.startup_banks.push_back(bank);
+	}
+	return 1;
+}
+
+const StartupTimingReport& FmodWrapper::getStartupTimingReport()
+{
+	static const StartupTimingReport no_report;
+	if (audio_engine == nullptr) { return no_report; }
+	return audio_engine->m_startup_report;
+}
+
+void FmodWrapper::initializeIdSystem()
+{
+	id_system = new IdSystem;
+}
+
+int FmodWrapper::setNumberOfListeners(int num_listeners)
+{
+	// Also called during initialization, before the engine is flagged as initialized.
+	if (audio_engine == nullptr) { return 0; }
+	if (num_listeners < 1 || num_listeners > FMOD_MAX_LISTENERS) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSetNumberOfListeners(num_listeners); }
+
+	int e;
+	e = errorCheck(audio_engine->studio_system->setNumListeners(num_listeners));
+	if (e == 1) { return 0; }
+	audio_engine->m_num_listeners = num_listeners;
+	return 1;
+}
+
+void FmodWrapper::callUpdate()
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordUpdate(); }
+	audio_engine->runUpdate();
+}
+
+void FmodWrapper::shutDownAudioEngine()
+{
+	if (!audio_engine_initialized) { return; }
+	stopCapture();
+	delete audio_engine;
+	delete id_system;
+	audio_engine = nullptr;
+	id_system = nullptr;
+	audio_engine_initialized = false;
+	std::cout << "Audio engine was shut down!" << std::endl;
+}
+
+int FmodWrapper::errorCheck(FMOD_RESULT result)
+{
+	if (result != FMOD_OK)
+	{
+		// Remember to change the output to the console of the deployed game engine.
+		std::cout << "FMOD ERROR " << result << std::endl;
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int FmodWrapper::startCapture(const std::string& file_path)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	if (call_recorder == nullptr)
+	{
+		call_recorder = new CallRecorder;
+	}
+
+	int r = call_recorder->open(file_path);
+	if (r == 0)
+	{
+		delete call_recorder;
+		call_recorder = nullptr;
+	}
+	return r;
+}
+
+int FmodWrapper::stopCapture()
+{
+	if (call_recorder == nullptr) { return 0; }
+
+	call_recorder->close();
+	delete call_recorder;
+	call_recorder = nullptr;
+	return 1;
+}
+
+int FmodWrapper::loadBank(const std::string& bank, bool load_samples)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBankOp(CallRecorder::op_load_bank, bank, load_samples); }
+
+	auto find_key = audio_engine->m_banks.find(bank);
+
+	if (find_key != audio_engine->m_banks.end())
+	{
+		// Bank is already loaded.
+		// If the sample data for this metadata is not yet loaded, use the loadSampleData function.
+
+		return 0;
+	}
+
+	FMOD::Studio::Bank* b = nullptr;
+	int e;
+	e = errorCheck(audio_engine->studio_system->loadBankFile(bank.c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &b));
+	if (e == 1) { return 0; }
+
+	if (load_samples)
+	{
+		e = errorCheck(b->loadSampleData());
+		if (e == 1)
+		{
+			b->unload();
+			return 0;
+		}
+		else
+		{
+			audio_engine->m_banks[bank] = b;
+			audio_engine->cacheMixerHandles(b);
+			audio_engine->m_manifest.addBank(bank, b);
+			return 1;
+		}
+	}
+	else
+	{
+		audio_engine->m_banks[bank] = b;
+		audio_engine->cacheMixerHandles(b);
+		audio_engine->m_manifest.addBank(bank, b);
+		return 1;
+	}	
+}
+
+int FmodWrapper::unloadBank(const std::string& bank)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBankOp(CallRecorder::op_unload_bank, bank); }
+
+	auto find_key = audio_engine->m_banks.find(bank);
+
+	if (find_key == audio_engine->m_banks.end())
+	{
+		// Bank requested for unloading is not loaded.
+		return 0;
+	}
+	else
+	{
+		int e;
+		e = errorCheck(find_key->second->unload());
+		if (e == 1) { return 0; }
+
+		// A reload in progress is abandoned. Its reader thread, if still running, owns the read buffer.
+		audio_engine->m_bank_reloads.erase(bank);
+
+		// Descriptions of the bank turn invalid, drop the parameter IDs resolved through them.
+		audio_engine->m_parameter_ids.clear();
+
+		audio_engine->m_memory_banks.erase(bank);
+		audio_engine->m_banks.erase(find_key);
+		return 1;
+	}
+}
+
+int FmodWrapper::captureAudioState(std::vector<unsigned char>& blob)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	// Staged attribute and parameter writes haven't reached FMOD yet.
+	audio_engine->flushStagedWrites();
+
+	SavedAudioState state;
+	state.events.reserve(audio_engine->m_events.size());
+
+	for (auto it = audio_engine->m_events.begin(); it != audio_engine->m_events.end(); ++it)
+	{
+		// Dialogue lines are left to the dialogue system, their programmer sounds can't be restarted from the event alone.
+		if (audio_engine->m_alloc_dialogue_user_data.find(it->first) != audio_engine->m_alloc_dialogue_user_data.end()) { continue; }
+
+		FMOD::Studio::EventInstance* instance = it->second;
+		FMOD_STUDIO_PLAYBACK_STATE pb_state = FMOD_STUDIO_PLAYBACK_STOPPED;
+		if (instance->getPlaybackState(&pb_state) != FMOD_OK) { continue; }
+		if (pb_state == FMOD_STUDIO_PLAYBACK_STOPPING || pb_state == FMOD_STUDIO_PLAYBACK_STOPPED) { continue; }
+
+		FMOD::Studio::EventDescription* description = nullptr;
+		if (instance->getDescription(&description) != FMOD_OK) { continue; }
+
+		SavedEventState event;
+		event.id = it->first;
+		if (description->getID(&event.guid) != FMOD_OK) { continue; }
+		instance->getTimelinePosition(&event.timeline_position);
+		instance->getPaused(&event.paused);
+		description->is3D(&event.is_3d);
+		if (event.is_3d) { instance->get3DAttributes(&event.attributes); }
+		event.emitter = audio_engine->m_emitter_registry.contains(it->first);
+
+		// Only the parameters the game sets. Read-only, automatic and global ones are restored by FMOD or the game itself.
+		int parameter_count = 0;
+		description->getParameterDescriptionCount(&parameter_count);
+		for (int i = 0; i < parameter_count; i++)
+		{
+			FMOD_STUDIO_PARAMETER_DESCRIPTION parameter_description;
+			if (description->getParameterDescriptionByIndex(i, &parameter_description) != FMOD_OK) { continue; }
+			if ((parameter_description.flags & (FMOD_STUDIO_PARAMETER_READONLY | FMOD_STUDIO_PARAMETER_AUTOMATIC | FMOD_STUDIO_PARAMETER_GLOBAL)) != 0) { continue; }
+
+			SavedParameter parameter;
+			parameter.id = parameter_description.id;
+			if (instance->getParameterByID(parameter.id, &parameter.value) == FMOD_OK) { event.parameters.push_back(parameter); }
+		}
+
+		state.events.push_back(event);
+	}
+
+	for (auto it = audio_engine->m_buses.begin(); it != audio_engine->m_buses.end(); ++it)
+	{
+		bool paused = false;
+		if (it->second->isValid() && it->second->getPaused(&paused) == FMOD_OK && paused) { state.paused_buses.push_back(it->first); }
+	}
+
+	AudioStateCodec::encode(state, blob);
+	audio_engine->m_audio_state_stats.captured_instances += (unsigned long int)state.events.size();
+	return 1;
+}
+
+int FmodWrapper::restoreAudioState(const std::vector<unsigned char>& blob, int instances_per_update, bool stop_current, std::vector<std::pair<unsigned long int, unsigned long int>>* id_map, float bank_timeout)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	// While capturing, the new IDs are needed for the record even if the caller didn't ask for them.
+	std::vector<std::pair<unsigned long int, unsigned long int>> recorded_ids;
+	if (id_map == nullptr && call_recorder != nullptr) { id_map = &recorded_ids; }
+	size_t first_pair = id_map != nullptr ? id_map->size() : 0;
+
+	int result = restoreAudioStateInternal(blob, instances_per_update, stop_current, id_map, bank_timeout);
+	if (call_recorder != nullptr)
+	{
+		std::vector<std::pair<unsigned long int, unsigned long int>> pairs(id_map->begin() + first_pair, id_map->end());
+		call_recorder->recordRestoreAudioState(blob, instances_per_update, stop_current, bank_timeout, pairs);
+	}
+	return result;
+}
+
+int FmodWrapper::restoreAudioStateInternal(const std::vector<unsigned char>& blob, int instances_per_update, bool stop_current, std::vector<std::pair<unsigned long int, unsigned long int>>* id_map, float bank_timeout)
+{
+	if (id_system == nullptr) { return 0; }
+
+	SavedAudioState state;
+	if (AudioStateCodec::decode(blob, state) == 0) { return 0; }
+
+	if (stop_current)
+	{
+		for (auto it = audio_engine->m_events.begin(); it != audio_engine->m_events.end(); ++it)
+		{
+			errorCheck(it->second->stop(FMOD_STUDIO_STOP_IMMEDIATE));
+		}
+		for (auto it = audio_engine->m_deferred_plays.begin(); it != audio_engine->m_deferred_plays.end(); ++it)
+		{
+			audio_engine->discardEventCallbacks(it->first);
+		}
+		audio_engine->m_deferred_plays.clear();
+	}
+
+	audio_engine->m_restore_budget = instances_per_update < 1 ? 1 : instances_per_update;
+
+	// The capture saved the paused buses among the cached ones, so every other cached bus was running.
+	for (auto it = audio_engine->m_buses.begin(); it != audio_engine->m_buses.end(); ++it)
+	{
+		if (!it->second->isValid()) { continue; }
+		if (std::find(state.paused_buses.begin(), state.paused_buses.end(), it->first) != state.paused_buses.end()) { continue; }
+
+		bool paused = false;
+		if (it->second->getPaused(&paused) == FMOD_OK && paused) { errorCheck(it->second->setPaused(false)); }
+	}
+	for (size_t i = 0; i < state.paused_buses.size(); i++)
+	{
+		FMOD::Studio::Bus* b = audio_engine->getBus(state.paused_buses[i]);
+		if (b != nullptr) { errorCheck(b->setPaused(true)); }
+	}
+
+	// Each instance becomes a deferred play resolved by GUID, so that the new IDs work with the other event functions right away.
+	for (size_t i = 0; i < state.events.size(); i++)
+	{
+		const SavedEventState& event = state.events[i];
+		unsigned long int id = id_system->getUniqueId();
+
+		DeferredPlay& deferred = audio_engine->m_deferred_plays[id];
+		deferred.event = BankManifest::guidToString(event.guid);
+		deferred.is_3d = event.is_3d;
+		if (event.is_3d) { deferred.attributes = event.attributes; }
+		deferred.restored = true;
+		deferred.timeline_position = event.timeline_position;
+		deferred.paused = event.paused;
+		deferred.register_emitter = event.emitter;
+		deferred.parameter_values = event.parameters;
+		deferred.restore_timeout = bank_timeout < 0.0f ? 0.0f : bank_timeout;
+
+		// A bank known from the manifest but not loaded is loaded in the background, as with lazy loading.
+		const std::string* bank = audio_engine->m_manifest.findBank(deferred.event);
+		if (bank != nullptr && audio_engine->requestBankLoad(*bank) != nullptr) { deferred.bank = *bank; }
+
+		if (id_map != nullptr) { id_map->push_back(std::pair<unsigned long int, unsigned long int>(event.id, id)); }
+	}
+	return 1;
+}
+
+AudioStateStats FmodWrapper::getAudioStateStats()
+{
+	if (!audio_engine_initialized) { return AudioStateStats(); }
+
+	AudioStateStats stats = audio_engine->m_audio_state_stats;
+	for (auto it = audio_engine->m_deferred_plays.begin(); it != audio_engine->m_deferred_plays.end(); ++it)
+	{
+		if (it->second.restored) { stats.pending_instances++; }
+	}
+	return stats;
+}
+
+int FmodWrapper::reloadBank(const std::string& bank, float drain_timeout)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordReloadBank(bank, drain_timeout); }
+
+	auto find_key = audio_engine->m_banks.find(bank);
+	if (find_key == audio_engine->m_banks.end()) { return 0; }
+	if (audio_engine->m_bank_reloads.find(bank) != audio_engine->m_bank_reloads.end()) { return 0; }
+
+	// The new version is loaded from memory, which the voiceover locale bank must not be (see "setVoiceoverLocale").
+	if (bank == audio_engine->m_voiceover_bank) { return 0; }
+
+	// A bank still loading (e.g. lazily) has nothing to swap yet.
+	FMOD_STUDIO_LOADING_STATE loading_state = FMOD_STUDIO_LOADING_STATE_ERROR;
+	find_key->second->getLoadingState(&loading_state);
+	if (loading_state != FMOD_STUDIO_LOADING_STATE_LOADED) { return 0; }
+
+	BankReload& reload = audio_engine->m_bank_reloads[bank];
+	reload.drain_timeout = drain_timeout < 0.0f ? 0.0f : drain_timeout;
+	reload.start_time = std::chrono::steady_clock::now();
+	reload.read = readBankFileAsync(bank);
+
+	audio_engine->m_bank_reload_stats.started++;
+	return 1;
+}
+
+bool FmodWrapper::isBankReloading(const std::string& bank)
+{
+	if (!audio_engine_initialized) { return false; }
+	return audio_engine->m_bank_reloads.find(bank) != audio_engine->m_bank_reloads.end();
+}
+
+BankReloadStats FmodWrapper::getBankReloadStats()
+{
+	if (!audio_engine_initialized) { return BankReloadStats(); }
+	return audio_engine->m_bank_reload_stats;
+}
+
+unsigned long int FmodWrapper::schedulePlayAtClock(const std::string& event, unsigned long long dsp_clock, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (id_system == nullptr || dsp_clock == 0) { return 0; }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	ScheduledPlay play;
+	play.event = event;
+	event_description->is3D(&play.is_3d);
+	if (play.is_3d && spatial_attributes != nullptr) { play.attributes = *spatial_attributes; }
+	else { play.is_3d = false; }
+	play.parameters = parameters;
+	play.dsp_clock = dsp_clock;
+
+	unsigned long int id = id_system->getUniqueId();
+	audio_engine->m_scheduled_plays[id] = play;
+	audio_engine->m_schedule.insert(std::pair<unsigned long long, unsigned long int>(dsp_clock, id));
+	audio_engine->m_schedule_stats.scheduled++;
+	return id;
+}
+
+unsigned long int FmodWrapper::schedulePlayAfterEvent(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = schedulePlayAfterEventInternal(event, reference_event_id, offset_seconds, spatial_attributes, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordSchedulePlayAfterEvent(event, reference_event_id, offset_seconds, spatial_attributes, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::schedulePlayAfterEventInternal(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	// A beat aligned reference without a time yet can't be offset from.
+	unsigned long long start = audio_engine->referenceStartClock(reference_event_id);
+	if (start == 0) { return 0; }
+
+	long long offset = (long long)std::llround(offset_seconds * audio_engine->m_sample_rate);
+	if (offset < 0 && (unsigned long long)(-offset) >= start) { return 0; }
+
+	return schedulePlayAtClock(event, start + offset, spatial_attributes, parameters);
+}
+
+unsigned long int FmodWrapper::schedulePlayOnBeat(const std::string& event, int reference_event_id, bool on_bar, int extra, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = schedulePlayOnBeatInternal(event, reference_event_id, on_bar, extra, spatial_attributes, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordSchedulePlayOnBeat(event, reference_event_id, on_bar, extra, spatial_attributes, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::schedulePlayOnBeatInternal(const std::string& event, int reference_event_id, bool on_bar, int extra, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	if (id_system == nullptr || extra < 0) { return 0; }
+	if (audio_engine->m_events.find(reference_event_id) == audio_engine->m_events.end() &&
+		audio_engine->m_scheduled_plays.find(reference_event_id) == audio_engine->m_scheduled_plays.end()) { return 0; }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	// The wrapper listens to the reference's beats through the regular callback path.
+	if (audio_engine->m_beat_subscriber == 0) { audio_engine->m_beat_subscriber = createCallbackSubscriber(trackReferenceBeat); }
+	if (subscribeEventCallbacks(audio_engine->m_beat_subscriber, reference_event_id, FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT) == 0) { return 0; }
+
+	ScheduledPlay play;
+	play.event = event;
+	event_description->is3D(&play.is_3d);
+	if (play.is_3d && spatial_attributes != nullptr) { play.attributes = *spatial_attributes; }
+	else { play.is_3d = false; }
+	play.parameters = parameters;
+	play.reference_id = reference_event_id;
+	play.on_bar = on_bar;
+	play.extra = extra;
+
+	unsigned long int id = id_system->getUniqueId();
+	audio_engine->m_scheduled_plays[id] = play;
+	audio_engine->m_schedule_stats.scheduled++;
+	return id;
+}
+
+void FmodWrapper::trackReferenceBeat(const EventCallbackMessage& message, void*)
+{
+	if (message.type != FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT) { return; }
+
+	// Messages can still arrive for an instance erased during the same update.
+	auto find_event = audio_engine->m_events.find(message.event_id);
+	if (find_event == audio_engine->m_events.end()) { return; }
+
+	ReferenceBeat& beat = audio_engine->m_reference_beats[message.event_id];
+	beat.tempo = message.tempo;
+	beat.beat = message.beat;
+	beat.time_signature_upper = message.time_signature_upper;
+
+	// The callback fires on the first studio update past the beat. When the reference was scheduled, its exact start and the beat's
+	// timeline position give the beat's exact time.
+	auto find_start = audio_engine->m_scheduled_start_clocks.find(message.event_id);
+	if (find_start != audio_engine->m_scheduled_start_clocks.end())
+	{
+		beat.dsp_clock = find_start->second + (unsigned long long)message.position * audio_engine->m_sample_rate / 1000;
+	}
+	else
+	{
+		// Otherwise step back from the current clock by how far the timeline has moved past the beat. The message's own clock
+		// is only sampled once per update and serves as the fallback.
+		beat.dsp_clock = message.dsp_clock;
+
+		int timeline_position = 0;
+		unsigned long long now = 0;
+		if (find_event->second->getTimelinePosition(&timeline_position) == FMOD_OK && timeline_position >= message.position &&
+			audio_engine->m_master_channel_group->getDSPClock(&now, nullptr) == FMOD_OK)
+		{
+			unsigned long long elapsed = (unsigned long long)(timeline_position - message.position) * audio_engine->m_sample_rate / 1000;
+			if (now > elapsed) { beat.dsp_clock = now - elapsed; }
+		}
+	}
+}
+
+unsigned long long FmodWrapper::getDSPClock()
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long long dsp_clock = 0;
+	errorCheck(audio_engine->m_master_channel_group->getDSPClock(&dsp_clock, nullptr));
+	return dsp_clock;
+}
+
+int FmodWrapper::getSampleRate()
+{
+	if (!audio_engine_initialized) { return 0; }
+	return audio_engine->m_sample_rate;
+}
+
+void FmodWrapper::setScheduleLookahead(float seconds)
+{
+	if (!audio_engine_initialized) { return; }
+	audio_engine->m_schedule_lookahead = seconds < 0.0f ? 0.0f : seconds;
+}
+
+ScheduleStats FmodWrapper::getScheduleStats()
+{
+	if (!audio_engine_initialized) { return ScheduleStats(); }
+
+	ScheduleStats stats = audio_engine->m_schedule_stats;
+	stats.pending = (unsigned long int)audio_engine->m_scheduled_plays.size();
+	return stats;
+}
+
+int FmodWrapper::addVoiceoverLocale(const std::string& locale, const std::string& bank_file)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (locale.empty() || bank_file.empty()) { return 0; }
+
+	audio_engine->m_voiceover_locales[locale] = bank_file;
+	return 1;
+}
+
+int FmodWrapper::setVoiceoverLocale(const std::string& locale)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	auto find_locale = audio_engine->m_voiceover_locales.find(locale);
+	if (find_locale == audio_engine->m_voiceover_locales.end()) { return 0; }
+	const std::string& bank = find_locale->second;
+	if (call_recorder != nullptr) { call_recorder->recordSetVoiceoverLocale(locale, bank); }
+
+	VoiceoverLocaleSwitch& locale_switch = audio_engine->m_voiceover_switch;
+	if (locale_switch.bank_handle != nullptr)
+	{
+		if (locale_switch.locale == locale) { return 1; }
+
+		// Replaces the target of the switch in progress.
+		locale_switch.bank_handle->unload();
+		locale_switch = VoiceoverLocaleSwitch();
+		audio_engine->m_voiceover_stats.pending_locale.clear();
+	}
+
+	if (bank == audio_engine->m_voiceover_bank) { return 1; }
+
+	locale_switch.locale = locale;
+	locale_switch.bank = bank;
+	locale_switch.start_time = std::chrono::steady_clock::now();
+
+	int max_bytes = 0;
+	FMOD::Memory_GetStats(&audio_engine->m_voiceover_stats.memory_before_switch, &max_bytes, false);
+	audio_engine->m_voiceover_stats.peak_switch_memory = audio_engine->m_voiceover_stats.memory_before_switch;
+
+	auto find_key = audio_engine->m_banks.find(bank);
+	if (find_key != audio_engine->m_banks.end())
+	{
+		// A bank loaded from memory takes the memory of its playing lines with it when the next switch unloads it.
+		if (audio_engine->m_memory_banks.find(bank) != audio_engine->m_memory_banks.end())
+		{
+			locale_switch = VoiceoverLocaleSwitch();
+			audio_engine->m_voiceover_stats.failed_switches++;
+			return 0;
+		}
+
+		// Already loaded through "loadBank", no need to wait.
+		locale_switch.bank_handle = find_key->second;
+		audio_engine->completeVoiceoverLocaleSwitch();
+		return 1;
+	}
+
+	// Metadata only, the audio table's sounds are opened from the bank file when the lines play.
+	int e = errorCheck(audio_engine->studio_system->loadBankFile(bank.c_str(), FMOD_STUDIO_LOAD_BANK_NONBLOCKING, &locale_switch.bank_handle));
+	if (e == 1)
+	{
+		locale_switch = VoiceoverLocaleSwitch();
+		audio_engine->m_voiceover_stats.failed_switches++;
+		return 0;
+	}
+
+	audio_engine->m_voiceover_stats.pending_locale = locale;
+	return 1;
+}
+
+std::string FmodWrapper::getVoiceoverLocale()
+{
+	if (!audio_engine_initialized) { return std::string(); }
+	return audio_engine->m_voiceover_stats.locale;
+}
+
+VoiceoverLocaleStats FmodWrapper::getVoiceoverLocaleStats()
+{
+	if (!audio_engine_initialized) { return VoiceoverLocaleStats(); }
+	return audio_engine->m_voiceover_stats;
+}
+
+int FmodWrapper::loadSampleData(const std::string& bank)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBankOp(CallRecorder::op_load_sample_data, bank); }
+
+	auto find_key = audio_engine->m_banks.find(bank);
+
+	if (find_key == audio_engine->m_banks.end())
+	{
+		// Bank metadata has not been loaded.
+		return 0;
+	}
+	else
+	{
+		int e;
+
+		FMOD_STUDIO_LOADING_STATE loading_state;
+		e = errorCheck(find_key->second->getSampleLoadingState(&loading_state));
+		if (e == 1) { return 0; }
+		
+		switch (loading_state)
+		{
+			case FMOD_STUDIO_LOADING_STATE_UNLOADING:
+				 // Debug message the reason of cancelling the sample data load to the game engine console?
+				 return 0;
+			case FMOD_STUDIO_LOADING_STATE_UNLOADED:
+				 e = errorCheck(find_key->second->loadSampleData());
+				 if (e == 1) { return 0; }
+				 else { return 1; }		
+			case FMOD_STUDIO_LOADING_STATE_LOADING:
+				 // Debug message the reason of cancelling the sample data load to the game engine console?
+				 return 0;
+			case FMOD_STUDIO_LOADING_STATE_LOADED:
+			     // Debug message the reason of cancelling the sample data load to the game engine console?
+				 return 0;
+			case FMOD_STUDIO_LOADING_STATE_ERROR:
+				 e = errorCheck(find_key->second->loadSampleData());
+				 if (e == 1) { return 0; }
+				 else { return 1; }
+			default:
+				 return 0;
+		}
+	}
+}
+
+int FmodWrapper::unloadSampleData(const std::string& bank)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBankOp(CallRecorder::op_unload_sample_data, bank); }
+
+	auto find_key = audio_engine->m_banks.find(bank);
+
+	if (find_key == audio_engine->m_banks.end())
+	{
+		// Bank metadata has not been loaded.
+		return 0;
+	}
+	else
+	{
+		int e;
+
+		FMOD_STUDIO_LOADING_STATE loading_state;
+		e = errorCheck(find_key->second->getSampleLoadingState(&loading_state));
+		if (e == 1) { return 0; }
+
+		switch (loading_state)
+		{
+		case FMOD_STUDIO_LOADING_STATE_UNLOADING:
+			// Debug message the reason of cancelling the sample data load to the game engine console?
+			return 0;
+		case FMOD_STUDIO_LOADING_STATE_UNLOADED:
+			// Debug message the reason of cancelling the sample data load to the game engine console?
+			return 0;
+		case FMOD_STUDIO_LOADING_STATE_LOADING:
+			// Debug message the reason of cancelling the sample data load to the game engine console?
+			return 0;
+		case FMOD_STUDIO_LOADING_STATE_LOADED:
+			e = errorCheck(find_key->second->unloadSampleData());
+			if (e == 1) { return 0; }
+			else { return 1; }
+		case FMOD_STUDIO_LOADING_STATE_ERROR:
+			e = errorCheck(find_key->second->unloadSampleData());
+			if (e == 1) { return 0; }
+			else { return 1; }
+		default:
+			return 0;
+		}
+	}
+}
+
+int FmodWrapper::buildBankManifest(const std::vector<std::string>& bank_files, const std::string& output_path)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	BankManifest manifest;
+
+	for (size_t i = 0; i < bank_files.size(); i++)
+	{
+		auto find_key = audio_engine->m_banks.find(bank_files[i]);
+		if (find_key != audio_engine->m_banks.end())
+		{
+			manifest.addBank(bank_files[i], find_key->second);
+			continue;
+		}
+
+		FMOD::Studio::Bank* b = nullptr;
+		int e = errorCheck(audio_engine->studio_system->loadBankFile(bank_files[i].c_str(), FMOD_STUDIO_LOAD_BANK_NORMAL, &b));
+		if (e == 1) { return 0; }
+
+		manifest.addBank(bank_files[i], b);
+		b->unload();
+	}
+
+	return manifest.save(output_path);
+}
+
+int FmodWrapper::loadBankManifest(const std::string& file_path)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBankOp(CallRecorder::op_load_bank_manifest, file_path); }
+	return audio_engine->m_manifest.load(file_path);
+}
+
+int FmodWrapper::saveBankManifest(const std::string& file_path)
+{
+	if (!audio_engine_initialized) { return 0; }
+	return audio_engine->m_manifest.save(file_path);
+}
+
+void FmodWrapper::setLazyBankLoading(bool enabled, float timeout_seconds)
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordSetLazyBankLoading(enabled, timeout_seconds); }
+	audio_engine->m_lazy_loading_enabled = enabled;
+	audio_engine->m_lazy_loading_timeout = timeout_seconds;
+}
+
+LazyLoadStats FmodWrapper::getLazyLoadStats()
+{
+	if (!audio_engine_initialized) { return LazyLoadStats(); }
+	return audio_engine->m_lazy_load_stats;
+}
+
+unsigned long int FmodWrapper::addStreamingZone(const StreamingZone& zone)
+{
+	if (!audio_engine_initialized || id_system == nullptr) { return 0; }
+
+	unsigned long int id = id_system->getUniqueId();
+	audio_engine->m_streaming_zones[id].zone = zone;
+	if (call_recorder != nullptr) { call_recorder->recordAddStreamingZone(zone, id); }
+	return id;
+}
+
+int FmodWrapper::removeStreamingZone(unsigned long int zone_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordIdOp(CallRecorder::op_remove_streaming_zone, zone_id); }
+
+	auto find_key = audio_engine->m_streaming_zones.find(zone_id);
+	if (find_key == audio_engine->m_streaming_zones.end()) { return 0; }
+
+	if (find_key->second.prefetched) { audio_engine->releaseZoneBanks(find_key->second); }
+	audio_engine->m_streaming_zones.erase(find_key);
+	return 1;
+}
+
+StreamingZoneStats FmodWrapper::getStreamingZoneStats()
+{
+	if (!audio_engine_initialized) { return StreamingZoneStats(); }
+	return audio_engine->m_streaming_zone_stats;
+}
+
+// "play3dEvent", "play2dEvent", "playDialogue3D" & "playDialogue2D"  -functions return a unique event instance ID to the caller. 
+// If necessary, caller can then later use this ID to update FMOD_3D_ATTRIBUTES and local parameters possibly assigned to the particular event instance.
+// Initial parameter values can be optionally provided in the function arguments.
+// Mixer snapshots could be played with these as well, but "activateSnapshot" shares instances between requests and ramps the intensity for the caller.
+// While capturing, the call is recorded once it has returned, along with the ID it handed out, so that a replay can remap later calls to its own IDs.
+
+unsigned long int FmodWrapper::play3DEvent(const std::string& event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = play3DEventInternal(event, spatial_attributes, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordPlay3D(event, spatial_attributes, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::play3DEventInternal(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	unsigned long int deferred_id = 0;
+	if (audio_engine->deferUntilBankLoaded(event, &spatial_attributes, parameters, deferred_id)) { return deferred_id; }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	FMOD::Studio::EventInstance* event_instance = nullptr;
+	int e = errorCheck(event_description->createInstance(&event_instance));
+	if (e == 1) { return 0; }
+
+	bool is_3d = false;
+	event_description->is3D(&is_3d);
+
+	if (is_3d)
+	{
+		e = errorCheck(event_instance->set3DAttributes(&spatial_attributes));
+		if (e == 1)
+		{
+			event_instance->release();
+			return 0;
+		}
+	}
+	else
+	{
+		// A 2D event played through the 3D path.
+		event_instance->release();
+		return 0;
+	}
+
+	if (!parameters.empty())
+	{
+		for(auto it = parameters.begin();  it != parameters.end(); it++)
+		{
+			std::string parameter = it->first;
+			float value = it->second;
+			errorCheck(event_instance->setParameterByName(parameter.c_str(), value, false));
+		}
+	}
+
+	if (id_system != nullptr)
+	{
+		unsigned long int id = id_system->getUniqueId();
+		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
+
+		e = errorCheck(event_instance->start());
+		if (e == 1) { return 0; }
+
+		return id;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+unsigned long int FmodWrapper::play2DEvent(const std::string& event, std::map<std::string, float> parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = play2DEventInternal(event, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordPlay2D(event, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::play2DEventInternal(const std::string& event, const std::map<std::string, float>& parameters)
+{
+	unsigned long int deferred_id = 0;
+	if (audio_engine->deferUntilBankLoaded(event, nullptr, parameters, deferred_id)) { return deferred_id; }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	FMOD::Studio::EventInstance* event_instance = nullptr;
+	int e = errorCheck(event_description->createInstance(&event_instance));
+	if (e == 1) { return 0; }
+
+	if (!parameters.empty())
+	{
+		for (auto it = parameters.begin(); it != parameters.end(); it++)
+		{
+			std::string parameter = it->first;
+			float value = it->second;
+			errorCheck(event_instance->setParameterByName(parameter.c_str(), value, false));
+		}
+	}
+
+	if (id_system != nullptr)
+	{
+		unsigned long int id = id_system->getUniqueId();
+		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, event_instance));
+
+		e = errorCheck(event_instance->start());
+		if (e == 1) { return 0; }
+		
+		return id;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int FmodWrapper::playOneShot3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordPlayOneShot3D(event, spatial_attributes, parameters); }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	// A looping or sustaining event would never stop, and nothing is left to stop it with.
+	bool oneshot = false;
+	if (event_description->isOneshot(&oneshot) != FMOD_OK || !oneshot) { return 0; }
+
+	bool is_3d = false;
+	event_description->is3D(&is_3d);
+	if (!is_3d) { return 0; }
+
+	FMOD::Studio::EventInstance* event_instance = nullptr;
+	int e = errorCheck(event_description->createInstance(&event_instance));
+	if (e == 1) { return 0; }
+
+	e = errorCheck(event_instance->set3DAttributes(&spatial_attributes));
+	if (e == 1)
+	{
+		event_instance->release();
+		return 0;
+	}
+
+	for (auto it = parameters.begin(); it != parameters.end(); it++)
+	{
+		errorCheck(event_instance->setParameterByName(it->first.c_str(), it->second, false));
+	}
+
+	e = errorCheck(event_instance->start());
+
+	// A released instance keeps playing and is destroyed by FMOD once it has stopped.
+	event_instance->release();
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+int FmodWrapper::playOneShot2D(const std::string& event, const std::map<std::string, float>& parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordPlayOneShot2D(event, parameters); }
+
+	FMOD::Studio::EventDescription* event_description = audio_engine->getEventDescription(event);
+	if (event_description == nullptr) { return 0; }
+
+	bool oneshot = false;
+	if (event_description->isOneshot(&oneshot) != FMOD_OK || !oneshot) { return 0; }
+
+	FMOD::Studio::EventInstance* event_instance = nullptr;
+	int e = errorCheck(event_description->createInstance(&event_instance));
+	if (e == 1) { return 0; }
+
+	for (auto it = parameters.begin(); it != parameters.end(); it++)
+	{
+		errorCheck(event_instance->setParameterByName(it->first.c_str(), it->second, false));
+	}
+
+	e = errorCheck(event_instance->start());
+	event_instance->release();
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+int FmodWrapper::stopEvent(int event_id, bool allow_fades)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordStop(event_id, allow_fades); }
+
+	// Clustered emitters have no instance of their own.
+	if (audio_engine->m_emitter_clusters.remove(event_id) == 1) { return 1; }
+
+	// Stopping a play that is still waiting for its bank or its time just cancels it.
+	if (audio_engine->m_deferred_plays.erase(event_id) == 1 || audio_engine->m_scheduled_plays.erase(event_id) == 1)
+	{
+		audio_engine->discardEventCallbacks(event_id);
+		return 1;
+	}
+
+	auto find_key = audio_engine->m_events.find(event_id);
+
+	if (find_key != audio_engine->m_events.end())
+	{
+		int e;
+
+		if (allow_fades)
+		{
+			e = errorCheck(find_key->second->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
+			if (e == 1) { return 0; }
+			return 1;
+		}
+		else
+		{
+			e = errorCheck(find_key->second->stop(FMOD_STUDIO_STOP_IMMEDIATE));
+			if (e == 1) { return 0; }
+			return 1;
+		}
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int FmodWrapper::set3DAttributes(int event_id, FMOD_3D_ATTRIBUTES spatial_attributes)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSet3DAttributes(event_id, spatial_attributes); }
+
+	auto find_deferred = audio_engine->m_deferred_plays.find(event_id);
+	if (find_deferred != audio_engine->m_deferred_plays.end())
+	{
+		find_deferred->second.attributes = spatial_attributes;
+		return 1;
+	}
+
+	if (audio_engine->m_emitter_clusters.setPosition(event_id, spatial_attributes.position) == 1) { return 1; }
+
+	audio_engine->m_occlusion.setPosition(event_id, spatial_attributes.position);
+
+	// Registered emitters are sent to FMOD by the emitter registry during the update.
+	if (audio_engine->m_emitter_registry.setAttributes(event_id, spatial_attributes) == 1) { return 1; }
+
+	auto find_key = audio_engine->m_events.find(event_id);
+
+	if (find_key != audio_engine->m_events.end())
+	{
+		if (audio_engine->m_coalescing_enabled)
+		{
+			// The write itself is only checked by FMOD during the update, so at least reject a dead handle now.
+			if (!find_key->second->isValid()) { return 0; }
+
+			StagedEventWrites& writes = audio_engine->m_staged_writes[find_key->first];
+			writes.instance = find_key->second;
+			if (writes.has_pending_attributes) { audio_engine->m_coalescing_stats.coalesced++; }
+			writes.pending_attributes = spatial_attributes;
+			writes.has_pending_attributes = true;
+			audio_engine->m_coalescing_stats.staged++;
+
+			if (!writes.queued)
+			{
+				writes.queued = true;
+				audio_engine->m_dirty_events.push_back(find_key->first);
+			}
+			return 1;
+		}
+
+		int e;
+
+		e = errorCheck(find_key->second->set3DAttributes(&spatial_attributes));
+		if (e == 1) { return 0; }
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int FmodWrapper::registerEmitter(int event_id, float cluster_weight)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordRegisterEmitter(event_id, cluster_weight); }
+
+	auto find_key = audio_engine->m_events.find(event_id);
+	if (find_key == audio_engine->m_events.end()) { return 0; }
+
+	FMOD::Studio::EventDescription* description = nullptr;
+	if (find_key->second->getDescription(&description) == FMOD_OK && audio_engine->m_emitter_clusters.isEnabled(description))
+	{
+		// Attributes set in the same frame may still be staged.
+		FMOD_3D_ATTRIBUTES attributes;
+		auto find_writes = audio_engine->m_staged_writes.find(find_key->first);
+		if (find_writes != audio_engine->m_staged_writes.end() && find_writes->second.has_pending_attributes) { attributes = find_writes->second.pending_attributes; }
+		else if (errorCheck(find_key->second->get3DAttributes(&attributes)) == 1) { return 0; }
+
+		// Usually called in the same frame as the play, so the instance is stopped before FMOD has started it.
+		find_key->second->stop(FMOD_STUDIO_STOP_IMMEDIATE);
+		find_key->second->release();
+		audio_engine->eraseEvent(find_key);
+
+		return audio_engine->m_emitter_clusters.add(event_id, description, attributes.position, cluster_weight);
+	}
+
+	return audio_engine->m_emitter_registry.add(find_key->first, find_key->second);
+}
+
+int FmodWrapper::unregisterEmitter(int event_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordEmitterOp(CallRecorder::op_unregister_emitter, event_id); }
+
+	if (audio_engine->m_emitter_clusters.remove(event_id) == 1) { return 1; }
+	return audio_engine->m_emitter_registry.remove(event_id);
+}
+
+int FmodWrapper::enableEmitterClustering(const std::string& event, const EmitterClusterSettings& settings)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordEnableEmitterClustering(event, settings); }
+
+	FMOD::Studio::EventDescription* description = audio_engine->getEventDescription(event);
+	if (description == nullptr) { return 0; }
+
+	return audio_engine->m_emitter_clusters.enable(event, description, settings);
+}
+
+int FmodWrapper::disableEmitterClustering(const std::string& event)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordDisableEmitterClustering(event); }
+
+	// Works without the event's bank as well, the group is found by the event string it was enabled with.
+	return audio_engine->m_emitter_clusters.disable(event);
+}
+
+EmitterClusterStats FmodWrapper::getEmitterClusterStats()
+{
+	if (!audio_engine_initialized) { return EmitterClusterStats(); }
+	return audio_engine->m_emitter_clusters.getStats();
+}
+
+void FmodWrapper::setEmitterLodSettings(const EmitterLodSettings& settings)
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordSetEmitterLodSettings(settings); }
+	audio_engine->m_emitter_registry.setSettings(settings);
+}
+
+EmitterStats FmodWrapper::getEmitterStats()
+{
+	if (!audio_engine_initialized) { return EmitterStats(); }
+	return audio_engine->m_emitter_registry.getStats();
+}
+
+int FmodWrapper::enableOcclusion(int event_id, const std::string& parameter)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordEnableOcclusion(event_id, parameter); }
+
+	auto find_key = audio_engine->m_events.find(event_id);
+	if (find_key == audio_engine->m_events.end()) { return 0; }
+
+	return audio_engine->m_occlusion.add(find_key->first, find_key->second, parameter);
+}
+
+int FmodWrapper::disableOcclusion(int event_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordIdOp(CallRecorder::op_disable_occlusion, (unsigned long int)event_id); }
+	return audio_engine->m_occlusion.remove(event_id);
+}
+
+void FmodWrapper::setOcclusionQuery(OcclusionQueryCallback callback, void* user_data)
+{
+	if (!audio_engine_initialized) { return; }
+	audio_engine->m_occlusion.setQuery(callback, user_data);
+}
+
+void FmodWrapper::setOcclusionSettings(const OcclusionSettings& settings)
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordSetOcclusionSettings(settings); }
+	audio_engine->m_occlusion.setSettings(settings);
+}
+
+OcclusionStats FmodWrapper::getOcclusionStats()
+{
+	if (!audio_engine_initialized) { return OcclusionStats(); }
+	return audio_engine->m_occlusion.getStats();
+}
+
+int FmodWrapper::setListenerAttributes(int listener_index, FMOD_3D_ATTRIBUTES spatial_attributes)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSetListenerAttributes(listener_index, spatial_attributes); }
+
+	int e;
+
+	e = errorCheck(audio_engine->studio_system->setListenerAttributes(listener_index, &spatial_attributes));
+	if (e == 1) { return 0; }
+
+	if (listener_index >= 0 && listener_index < FMOD_MAX_LISTENERS)
+	{
+		audio_engine->m_listeners[listener_index] = spatial_attributes;
+	}
+	return 1;
+}
+
+int FmodWrapper::setListenerAttributesBatch(const ListenerTransformsSoA& transforms, int count, int first_listener)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (first_listener < 0 || count < 0 || first_listener + count > audio_engine->m_num_listeners) { return 0; }
+
+	// Position, forward and up are required, velocity is optional.
+	const float* required[9] = { transforms.position_x, transforms.position_y, transforms.position_z,
+		transforms.forward_x, transforms.forward_y, transforms.forward_z, transforms.up_x, transforms.up_y, transforms.up_z };
+	for (int i = 0; i < 9; i++)
+	{
+		if (required[i] == nullptr) { return 0; }
+	}
+
+	bool has_velocity = transforms.velocity_x != nullptr && transforms.velocity_y != nullptr && transforms.velocity_z != nullptr;
+	int succeeded = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		int listener_index = first_listener + i;
+		FMOD_3D_ATTRIBUTES attributes;
+
+		attributes.position = { transforms.position_x[i], transforms.position_y[i], transforms.position_z[i] };
+		attributes.forward = { transforms.forward_x[i], transforms.forward_y[i], transforms.forward_z[i] };
+		attributes.up = { transforms.up_x[i], transforms.up_y[i], transforms.up_z[i] };
+		if (has_velocity) { attributes.velocity = { transforms.velocity_x[i], transforms.velocity_y[i], transforms.velocity_z[i] }; }
+		else { attributes.velocity = { 0.0f, 0.0f, 0.0f }; }
+
+		if (call_recorder != nullptr) { call_recorder->recordSetListenerAttributes(listener_index, attributes); }
+
+		int e = errorCheck(audio_engine->studio_system->setListenerAttributes(listener_index, &attributes));
+		if (e == 1) { continue; }
+
+		audio_engine->m_listeners[listener_index] = attributes;
+		succeeded++;
+	}
+
+	return succeeded == count ? 1 : 0;
+}
+
+int FmodWrapper::setListenerWeight(int listener_index, float weight)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (listener_index < 0 || listener_index >= audio_engine->m_num_listeners) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSetListenerWeight(listener_index, weight); }
+
+	int e;
+	e = errorCheck(audio_engine->studio_system->setListenerWeight(listener_index, weight));
+	if (e == 1) { return 0; }
+
+	audio_engine->m_listener_weights[listener_index] = weight;
+	return 1;
+}
+
+int FmodWrapper::setParameterByName(int event_id, std::string& parameter, float value)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSetParameter(event_id, parameter, value); }
+
+	auto find_deferred = audio_engine->m_deferred_plays.find(event_id);
+	if (find_deferred != audio_engine->m_deferred_plays.end())
+	{
+		find_deferred->second.parameters[parameter] = value;
+		return 1;
+	}
+
+	auto find_key = audio_engine->m_events.find(event_id);
+
+	if (find_key != audio_engine->m_events.end())
+	{
+		if (audio_engine->m_coalescing_enabled)
+		{
+			// The write itself is only checked by FMOD during the update, so reject a dead handle or an unknown parameter now.
+			if (!find_key->second->isValid()) { return 0; }
+
+			StagedEventWrites& writes = audio_engine->m_staged_writes[find_key->first];
+			writes.instance = find_key->second;
+
+			StagedParameter* staged = nullptr;
+			for (size_t i = 0; i < writes.parameters.size(); i++)
+			{
+				if (writes.parameters[i].name == parameter)
+				{
+					staged = &writes.parameters[i];
+					break;
+				}
+			}
+			if (staged == nullptr)
+			{
+				FMOD_STUDIO_PARAMETER_ID id;
+				if (!audio_engine->resolveParameterId(find_key->second, parameter, id)) { return 0; }
+
+				writes.parameters.push_back(StagedParameter());
+				staged = &writes.parameters.back();
+				staged->name = parameter;
+				staged->id = id;
+			}
+
+			if (staged->has_pending) { audio_engine->m_coalescing_stats.coalesced++; }
+			staged->pending_value = value;
+			staged->has_pending = true;
+			audio_engine->m_coalescing_stats.staged++;
+
+			if (!writes.queued)
+			{
+				writes.queued = true;
+				audio_engine->m_dirty_events.push_back(find_key->first);
+			}
+			return 1;
+		}
+
+		int e;
+		e = errorCheck(find_key->second->setParameterByName(parameter.c_str(), value));
+		if (e == 1) { return 0; }
+		return 1;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+int FmodWrapper::setGlobalParameterByName(std::string& parameter, float value)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSetGlobalParameter(parameter, value); }
+
+	int e;
+
+	e = errorCheck(audio_engine->studio_system->setParameterByName(parameter.c_str(), value, false));
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+void FmodWrapper::setUpdateCoalescing(bool enabled, float parameter_epsilon, float movement_threshold)
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordSetUpdateCoalescing(enabled, parameter_epsilon, movement_threshold); }
+
+	// Send whatever is still staged, so that turning coalescing off doesn't lose the writes of the current frame.
+	if (!enabled) { audio_engine->flushStagedWrites(); }
+
+	audio_engine->m_coalescing_enabled = enabled;
+	audio_engine->m_parameter_epsilon = parameter_epsilon;
+	audio_engine->m_movement_threshold = movement_threshold;
+}
+
+CoalescingStats FmodWrapper::getCoalescingStats()
+{
+	if (!audio_engine_initialized) { return CoalescingStats(); }
+	return audio_engine->m_coalescing_stats;
+}
+
+int FmodWrapper::setBusPauseStatus(const std::string& bus, bool is_paused)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBusOp(CallRecorder::op_set_bus_paused, bus, is_paused); }
+
+	FMOD::Studio::Bus* b = audio_engine->getBus(bus);
+	if (b == nullptr) { return 0; }
+
+	int e;
+	e = errorCheck(b->setPaused(is_paused));
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+int FmodWrapper::stopAllBusEvents(const std::string& bus, bool allow_fades)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordBusOp(CallRecorder::op_stop_bus_events, bus, allow_fades); }
+
+	FMOD::Studio::Bus* b = audio_engine->getBus(bus);
+	if (b == nullptr) { return 0; }
+
+	int e;
+
+	if (allow_fades)
+	{
+		e = errorCheck(b->stopAllEvents(FMOD_STUDIO_STOP_ALLOWFADEOUT));
+		if (e == 1) { return 0; }
+		return 1;
+	}
+	else
+	{
+		e = errorCheck(b->stopAllEvents(FMOD_STUDIO_STOP_IMMEDIATE));
+		if (e == 1) { return 0; }
+		return 1;
+	}
+}
+
+int FmodWrapper::setBusVolume(const std::string& bus, float volume, float fade_seconds)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordMixerVolume(CallRecorder::op_set_bus_volume, bus, volume, fade_seconds); }
+
+	FMOD::Studio::Bus* b = audio_engine->getBus(bus);
+	if (b == nullptr) { return 0; }
+
+	int e;
+
+	if (fade_seconds > 0.0f)
+	{
+		float current_volume = 1.0f;
+		e = errorCheck(b->getVolume(&current_volume));
+		if (e == 1) { return 0; }
+		audio_engine->startMixerFade(b, nullptr, current_volume, volume, fade_seconds);
+		return 1;
+	}
+
+	audio_engine->cancelMixerFade(b, nullptr);
+	e = errorCheck(b->setVolume(volume));
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+int FmodWrapper::setVCAVolume(const std::string& vca, float volume, float fade_seconds)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordMixerVolume(CallRecorder::op_set_vca_volume, vca, volume, fade_seconds); }
+
+	FMOD::Studio::VCA* v = audio_engine->getVCA(vca);
+	if (v == nullptr) { return 0; }
+
+	int e;
+
+	if (fade_seconds > 0.0f)
+	{
+		float current_volume = 1.0f;
+		e = errorCheck(v->getVolume(&current_volume));
+		if (e == 1) { return 0; }
+		audio_engine->startMixerFade(nullptr, v, current_volume, volume, fade_seconds);
+		return 1;
+	}
+
+	audio_engine->cancelMixerFade(nullptr, v);
+	e = errorCheck(v->setVolume(volume));
+	if (e == 1) { return 0; }
+	return 1;
+}
+
+int FmodWrapper::setBusPauseStatusBatch(const std::vector<std::string>& buses, bool is_paused)
+{
+	int r = 1;
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		if (setBusPauseStatus(buses[i], is_paused) == 0) { r = 0; }
+	}
+	return r;
+}
+
+int FmodWrapper::stopAllBusEventsBatch(const std::vector<std::string>& buses, bool allow_fades)
+{
+	int r = 1;
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		if (stopAllBusEvents(buses[i], allow_fades) == 0) { r = 0; }
+	}
+	return r;
+}
+
+int FmodWrapper::setBusVolumeBatch(const std::vector<std::string>& buses, float volume, float fade_seconds)
+{
+	int r = 1;
+	for (size_t i = 0; i < buses.size(); i++)
+	{
+		if (setBusVolume(buses[i], volume, fade_seconds) == 0) { r = 0; }
+	}
+	return r;
+}
+
+int FmodWrapper::setVCAVolumeBatch(const std::vector<std::string>& vcas, float volume, float fade_seconds)
+{
+	int r = 1;
+	for (size_t i = 0; i < vcas.size(); i++)
+	{
+		if (setVCAVolume(vcas[i], volume, fade_seconds) == 0) { r = 0; }
+	}
+	return r;
+}
+
+unsigned long int FmodWrapper::addBusMeter(const std::string& bus)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (id_system == nullptr) { return 0; }
+
+	unsigned long int id = 0;
+	FMOD::Studio::Bus* b = audio_engine->getBus(bus);
+	if (b != nullptr)
+	{
+		id = id_system->getUniqueId();
+		if (audio_engine->m_level_meters.addBus(id, b) == 0) { id = 0; }
+	}
+
+	if (call_recorder != nullptr) { call_recorder->recordAddBusMeter(bus, id); }
+	return id;
+}
+
+int FmodWrapper::removeMeter(unsigned long int meter_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordIdOp(CallRecorder::op_remove_meter, meter_id); }
+	return audio_engine->m_level_meters.remove(meter_id);
+}
+
+void FmodWrapper::setMeterSmoothing(float attack_seconds, float release_seconds)
+{
+	if (!audio_engine_initialized) { return; }
+	if (call_recorder != nullptr) { call_recorder->recordSetMeterSmoothing(attack_seconds, release_seconds); }
+	audio_engine->m_level_meters.setSmoothing(attack_seconds, release_seconds);
+}
+
+const MeterReading* FmodWrapper::getMeterReadings(int& count)
+{
+	count = 0;
+	if (!audio_engine_initialized) { return nullptr; }
+	return audio_engine->m_level_meters.getReadings(count);
+}
+
+unsigned long int FmodWrapper::activateSnapshot(const std::string& snapshot, float intensity, int priority, float ramp_seconds)
+{
+	if (!audio_engine_initialized || id_system == nullptr) { return 0; }
+
+	unsigned long int id = activateSnapshotInternal(snapshot, intensity, priority, ramp_seconds);
+	if (call_recorder != nullptr) { call_recorder->recordActivateSnapshot(snapshot, intensity, priority, ramp_seconds, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::activateSnapshotInternal(const std::string& snapshot, float intensity, int priority, float ramp_seconds)
+{
+	ActiveSnapshot& active = audio_engine->m_snapshots[snapshot];
+
+	// The bank of the snapshot may have been unloaded or reloaded since, before the next update got to notice.
+	if (active.instance != nullptr && !active.instance->isValid()) { active.instance = nullptr; }
+
+	if (active.instance == nullptr)
+	{
+		if (audio_engine->startSnapshotInstance(snapshot, active) == 0)
+		{
+			audio_engine->forgetSnapshotRequests(active);
+			audio_engine->m_snapshots.erase(snapshot);
+			audio_engine->sortActiveSnapshots();
+			return 0;
+		}
+
+		// Ramped activations start from silence, immediate ones at full requested intensity on the first update.
+		// A restarted snapshot with requests of its own continues at its current intensity.
+		if (active.requests.empty()) { active.current_intensity = ramp_seconds > 0.0f ? 0.0f : intensity; }
+	}
+
+	// Re-activating a snapshot that is ramping out cancels the release.
+	active.releasing = false;
+
+	unsigned long int id = id_system->getUniqueId();
+	active.requests.push_back({ id, priority, intensity });
+	audio_engine->m_snapshot_requests[id] = snapshot;
+
+	audio_engine->retargetSnapshot(active, ramp_seconds);
+	audio_engine->sortActiveSnapshots();
+	return id;
+}
+
+int FmodWrapper::setSnapshotIntensity(unsigned long int request_id, float intensity, float ramp_seconds)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordSnapshotIntensity(request_id, intensity, ramp_seconds); }
+
+	auto find_key = audio_engine->m_snapshot_requests.find(request_id);
+	if (find_key == audio_engine->m_snapshot_requests.end()) { return 0; }
+
+	ActiveSnapshot& active = audio_engine->m_snapshots[find_key->second];
+	for (size_t i = 0; i < active.requests.size(); i++)
+	{
+		if (active.requests[i].id == request_id) { active.requests[i].intensity = intensity; }
+	}
+
+	audio_engine->retargetSnapshot(active, ramp_seconds);
+	return 1;
+}
+
+int FmodWrapper::releaseSnapshot(unsigned long int request_id, float ramp_seconds)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (call_recorder != nullptr) { call_recorder->recordReleaseSnapshot(request_id, ramp_seconds); }
+
+	auto find_key = audio_engine->m_snapshot_requests.find(request_id);
+	if (find_key == audio_engine->m_snapshot_requests.end()) { return 0; }
+
+	ActiveSnapshot& active = audio_engine->m_snapshots[find_key->second];
+	audio_engine->m_snapshot_requests.erase(find_key);
+
+	for (size_t i = 0; i < active.requests.size(); i++)
+	{
+		if (active.requests[i].id == request_id)
+		{
+			active.requests.erase(active.requests.begin() + i);
+			break;
+		}
+	}
+
+	if (active.requests.empty())
+	{
+		// Ramp down to zero, the instance is stopped by the update once the ramp has finished.
+		active.releasing = true;
+		active.target_intensity = 0.0f;
+		active.ramp_rate = ramp_seconds > 0.0f ? active.current_intensity / ramp_seconds : 0.0f;
+		active.intensity_dirty = ramp_seconds > 0.0f;
+	}
+	else
+	{
+		audio_engine->retargetSnapshot(active, ramp_seconds);
+	}
+
+	audio_engine->sortActiveSnapshots();
+	return 1;
+}
+
+bool FmodWrapper::isSnapshotActive(const std::string& snapshot)
+{
+	if (!audio_engine_initialized) { return false; }
+
+	auto find_key = audio_engine->m_snapshots.find(snapshot);
+	return find_key != audio_engine->m_snapshots.end() && !find_key->second.releasing;
+}
+
+const std::vector<std::string>& FmodWrapper::getActiveSnapshots()
+{
+	static const std::vector<std::string> no_snapshots;
+	if (!audio_engine_initialized) { return no_snapshots; }
+	return audio_engine->m_active_snapshot_names;
+}
+
+unsigned long int FmodWrapper::createCallbackSubscriber(EventCallbackHandler handler, void* user_data, unsigned int capacity)
+{
+	if (!audio_engine_initialized) { return 0; }
+	if (handler == nullptr || capacity == 0) { return 0; }
+	if (id_system == nullptr) { return 0; }
+
+	unsigned long int id = id_system->getUniqueId();
+	audio_engine->m_callback_subscribers[id] = new CallbackSubscriber(handler, user_data, capacity);
+	return id;
+}
+
+int FmodWrapper::removeCallbackSubscriber(unsigned long int subscriber_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	auto find_key = audio_engine->m_callback_subscribers.find(subscriber_id);
+	if (find_key == audio_engine->m_callback_subscribers.end()) { return 0; }
+
+	find_key->second->active.store(false, std::memory_order_relaxed);
+	return 1;
+}
+
+unsigned long int FmodWrapper::getDroppedCallbacks(unsigned long int subscriber_id)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	auto find_key = audio_engine->m_callback_subscribers.find(subscriber_id);
+	if (find_key == audio_engine->m_callback_subscribers.end()) { return 0; }
+	return find_key->second->dropped.load(std::memory_order_relaxed);
+}
+
+int FmodWrapper::subscribeEventCallbacks(unsigned long int subscriber_id, int event_id, FMOD_STUDIO_EVENT_CALLBACK_TYPE types)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	auto find_subscriber = audio_engine->m_callback_subscribers.find(subscriber_id);
+	if (find_subscriber == audio_engine->m_callback_subscribers.end()) { return 0; }
+
+	// Lifecycle of the user data itself is handled by the wrapper.
+	types &= ~FMOD_STUDIO_EVENT_CALLBACK_DESTROYED;
+	if (types == 0) { return 0; }
+
+	auto find_event = audio_engine->m_events.find(event_id);
+	bool deferred = audio_engine->m_deferred_plays.find(event_id) != audio_engine->m_deferred_plays.end() ||
+					audio_engine->m_scheduled_plays.find(event_id) != audio_engine->m_scheduled_plays.end();
+	if (find_event == audio_engine->m_events.end() && !deferred) { return 0; }
+
+	EventCallbackData* data = nullptr;
+	bool created = false;
+
+	auto find_dialogue = audio_engine->m_alloc_dialogue_user_data.find(event_id);
+	if (find_dialogue != audio_engine->m_alloc_dialogue_user_data.end()) { data = &find_dialogue->second->callbacks; }
+	else
+	{
+		auto find_key = audio_engine->m_event_callback_data.find(event_id);
+		if (find_key != audio_engine->m_event_callback_data.end()) { data = find_key->second; }
+		else
+		{
+			data = new EventCallbackData();
+			data->event_id = event_id;
+			audio_engine->m_event_callback_data[event_id] = data;
+			created = true;
+		}
+	}
+
+	int count = data->count.load(std::memory_order_relaxed);
+	int slot = 0;
+	for (; slot < count; slot++)
+	{
+		if (data->subscribers[slot] == find_subscriber->second) { break; }
+	}
+
+	if (slot < count)
+	{
+		data->types[slot].fetch_or(types, std::memory_order_relaxed);
+	}
+	else
+	{
+		if (count == EventCallbackData::max_subscribers) { return 0; }
+
+		// Fill the slot first and then publish it, FMOD's thread only reads slots below "count".
+		data->subscribers[count] = find_subscriber->second;
+		data->types[count].store(types, std::memory_order_relaxed);
+		data->count.store(count + 1, std::memory_order_release);
+	}
+
+	// A deferred play gets its callbacks attached when it is started.
+	if (deferred) { return 1; }
+
+	int r = audio_engine->attachEventCallbacks(event_id, find_event->second);
+	if (r == 0 && created)
+	{
+		audio_engine->m_event_callback_data.erase(event_id);
+		delete data;
+	}
+	return r;
+}
+
+FMOD_RESULT F_CALLBACK FmodWrapper::eventCallbackRouter(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void* parameter)
+{
+	auto instance = (FMOD::Studio::EventInstance*)event;
+	void* user_data = nullptr;
+	if (instance->getUserData(&user_data) != FMOD_OK || user_data == nullptr) { return FMOD_OK; }
+
+	EventCallbackData* data = (EventCallbackData*)user_data;
+
+	if (type == FMOD_STUDIO_EVENT_CALLBACK_DESTROYED)
+	{
+		ReleasedUserData released;
+		released.event_id = data->event_id;
+		released.data = data;
+		released.is_dialogue = false;
+		if (!audio_engine->m_released_user_data.push(released))
+		{
+			audio_engine->m_released_user_data_overflows.fetch_add(1, std::memory_order_relaxed);
+			audio_engine->m_unswept_user_data.fetch_add(1, std::memory_order_release);
+		}
+		return FMOD_OK;
+	}
+
+	publishEventCallback(data, type, parameter, audio_engine->m_mix_clock.load(std::memory_order_relaxed));
+	return FMOD_OK;
+}
+
+FMOD_RESULT F_CALLBACK FmodWrapper::dialogueEventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void *parameter)
+{
+	// Runs on FMOD's thread. Anything touching the wrapper's bookkeeping is handed over to the game thread through a ring.
+	int e;
+	auto instance = (FMOD::Studio::EventInstance*)event;
+	void* user_data = nullptr;
+	e = errorCheck(instance->getUserData(&user_data));
+	if (e == 1 || user_data == nullptr) { return FMOD_OK; }
+
+	DialogueUserData* dialogue_user_data = (DialogueUserData*)user_data;
+
+	switch (type)
+	{
+		case FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND:
+		{
+			FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES* properties = (FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES*)parameter;
+			int locale_generation = audio_engine->m_voiceover_generation.load(std::memory_order_acquire);
+			FMOD_STUDIO_SOUND_INFO sound_info;
+			e = errorCheck(audio_engine->studio_system->getSoundInfo(dialogue_user_data->line_key.c_str(), &sound_info));
+			if (e == 1) { break; }
+
+			// "exinfo.length" is the size of the line within the bank file.
+			const DialogueSoundSettings& settings = audio_engine->m_dialogue_sound_settings;
+			unsigned int line_bytes = sound_info.exinfo.length;
+			float estimated_seconds = settings.encoded_bytes_per_second > 0.0f ? (float)line_bytes / settings.encoded_bytes_per_second : 0.0f;
+			bool stream = line_bytes >= settings.stream_min_bytes || estimated_seconds >= settings.stream_min_seconds;
+
+			if (stream && !audio_engine->acquireDialogueStream())
+			{
+				audio_engine->m_dialogue_stream_fallbacks.fetch_add(1, std::memory_order_relaxed);
+				stream = false;
+			}
+
+			FMOD_MODE sound_mode = FMOD_DEFAULT;
+			sound_mode |= FMOD_LOOP_NORMAL;
+			sound_mode |= stream ? FMOD_CREATESTREAM : FMOD_CREATECOMPRESSEDSAMPLE;
+			sound_mode |= FMOD_NONBLOCKING;
+
+			if (dialogue_user_data->is_3d)
+			{
+				sound_mode |= FMOD_3D;
+			}
+
+			// "decodebuffersize" is in PCM samples. The line's own rate isn't known before it has been opened, so the output rate stands in for it.
+			if (stream) { sound_info.exinfo.decodebuffersize = (unsigned int)((unsigned long long)settings.stream_decode_buffer_ms * audio_engine->m_sample_rate / 1000); }
+
+			FMOD::Sound* dialogue_sound = nullptr;
+			e = errorCheck(audio_engine->core_system->createSound(sound_info.name_or_data, sound_mode, &sound_info.exinfo, &dialogue_sound)); 
+
+			if (e == 1) 
+			{
+				if (stream) { audio_engine->m_open_dialogue_streams.fetch_sub(1, std::memory_order_relaxed); }
+				break; 
+			}
+
+			dialogue_user_data->streamed = stream;
+			dialogue_user_data->locale_generation = locale_generation;
+			audio_engine->m_voiceover_lines[locale_generation % WrapperImplementation::max_voiceover_generations].fetch_add(1, std::memory_order_relaxed);
+			if (stream)
+			{
+				audio_engine->m_dialogue_streams_opened.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				// A compressed sample keeps the line's encoded data resident for as long as it plays.
+				dialogue_user_data->sample_bytes = line_bytes;
+				audio_engine->m_dialogue_samples_created.fetch_add(1, std::memory_order_relaxed);
+				unsigned long long sample_bytes = audio_engine->m_dialogue_sample_bytes.fetch_add(line_bytes, std::memory_order_relaxed) + line_bytes;
+				unsigned long long peak = audio_engine->m_peak_dialogue_sample_bytes.load(std::memory_order_relaxed);
+				while (sample_bytes > peak && !audio_engine->m_peak_dialogue_sample_bytes.compare_exchange_weak(peak, sample_bytes, std::memory_order_relaxed)) {}
+			}
+
+			FMOD_SOUND* cast_dialogue_sound = (FMOD_SOUND*)dialogue_sound;
+			properties->sound = cast_dialogue_sound;
+			properties->subsoundIndex = sound_info.subsoundindex;
+		}
+		break;
+	
+		case FMOD_STUDIO_EVENT_CALLBACK_STOPPED:
+		{
+			instance->release();			
+		}
+		break;
+
+		//  When this callback happens, inform the dialogue system that the current line has finished.
+		//  Maybe also add another system on the game engine side that allows for a wait before the next line is triggered for dialogue pacing purposes.
+		//  Interrupting lines are their own special case, since the next line has to be triggered before the current one has been destoryed.
+		case FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND: 
+		{			
+			FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES* properties = (FMOD_STUDIO_PROGRAMMER_SOUND_PROPERTIES*)parameter;
+			FMOD::Sound* cast_dialogue_sound = (FMOD::Sound*)properties->sound;
+			cast_dialogue_sound->release();			
+
+			if (dialogue_user_data->streamed)
+			{
+				audio_engine->m_open_dialogue_streams.fetch_sub(1, std::memory_order_relaxed);
+				dialogue_user_data->streamed = false;
+			}
+			else
+			{
+				audio_engine->m_dialogue_sample_bytes.fetch_sub(dialogue_user_data->sample_bytes, std::memory_order_relaxed);
+				dialogue_user_data->sample_bytes = 0;
+			}
+
+			if (dialogue_user_data->locale_generation != -1)
+			{
+				int slot = dialogue_user_data->locale_generation % WrapperImplementation::max_voiceover_generations;
+				audio_engine->m_voiceover_lines[slot].fetch_sub(1, std::memory_order_relaxed);
+				dialogue_user_data->locale_generation = -1;
+			}
+		}
+		break;
+
+		case FMOD_STUDIO_EVENT_CALLBACK_DESTROYED:
+		{
+			// The user data is erased from the bookkeeping and deleted by the next update.
+			ReleasedUserData released;
+			released.event_id = dialogue_user_data->associated_event_id;
+			released.data = dialogue_user_data;
+			released.is_dialogue = true;
+			if (!audio_engine->m_released_user_data.push(released))
+			{
+				audio_engine->m_released_user_data_overflows.fetch_add(1, std::memory_order_relaxed);
+				audio_engine->m_unswept_user_data.fetch_add(1, std::memory_order_release);
+			}
+		}
+		return FMOD_OK;
+	}
+
+	// Subscribers of the dialogue event (e.g. for STOPPED to pace the next line).
+	publishEventCallback(&dialogue_user_data->callbacks, type, parameter, audio_engine->m_mix_clock.load(std::memory_order_relaxed));
+	return FMOD_OK;
+}
+
+unsigned long int FmodWrapper::playDialogue3D(const std::string key, DialogueMasterEvents master_event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters)
+{
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = playDialogue3DInternal(key, master_event, spatial_attributes, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordPlayDialogue3D(key, master_event, spatial_attributes, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::playDialogue3DInternal(const std::string& key, DialogueMasterEvents master_event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters)
+{
+	std::string dialogue_master_event;
+
+	switch (master_event)
+	{
+		case PC:
+			dialogue_master_event = "event:/PC_Dialogue_Master";
+			break;
+		case NPC:
+			dialogue_master_event = "event:/NPC_Dialogue_Master";
+			break;
+		default:
+			return 0;
+	}
+
+	FMOD::Studio::EventDescription* dialogue_event_description = audio_engine->getEventDescription(dialogue_master_event);
+	if (dialogue_event_description == nullptr) { return 0; }
+
+	FMOD::Studio::EventInstance* dialogue_event_instance = nullptr;
+	int e = errorCheck(dialogue_event_description->createInstance(&dialogue_event_instance));
+	if (e == 1) { return 0; } 
+
+	bool is_3d = false;
+	dialogue_event_description->is3D(&is_3d);
+
+	if (is_3d)
+	{
+		e = errorCheck(dialogue_event_instance->set3DAttributes(&spatial_attributes));
+		if (e == 1) { return 0; }
+	}
+	else
+	{
+		return 0;
+	}
+
+	if (!parameters.empty())
+	{
+		for (auto it = parameters.begin(); it != parameters.end(); it++)
+		{
+			std::string parameter = it->first;
+			float value = it->second;
+			errorCheck(dialogue_event_instance->setParameterByName(parameter.c_str(), value, false));
+		}
+	}
+
+	if (id_system != nullptr)
+	{
+		unsigned long int id = id_system->getUniqueId();
+		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, dialogue_event_instance));
+
+		dialogue_event_instance->setCallback(dialogueEventCallback,
+											 FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND |
+											 FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND |
+											 FMOD_STUDIO_EVENT_CALLBACK_STOPPED |
+											 FMOD_STUDIO_EVENT_CALLBACK_DESTROYED);
+
+		DialogueUserData* dialogue_user_data = new DialogueUserData();
+		dialogue_user_data->is_3d = true;
+		dialogue_user_data->line_key = key;
+		dialogue_user_data->associated_event_id = id;
+		dialogue_user_data->callbacks.event_id = id;
+		dialogue_user_data->callbacks.instance = dialogue_event_instance;
+		audio_engine->m_alloc_dialogue_user_data.insert(std::pair<unsigned long int, DialogueUserData*>(id, dialogue_user_data));
+
+		e = errorCheck(dialogue_event_instance->setUserData(dialogue_user_data));
+		if (e == 1) 
+		{
+			audio_engine->m_alloc_dialogue_user_data.erase(id);
+			delete dialogue_user_data;
+			dialogue_user_data = nullptr;
+			return 0; 
+		}
+
+		e = errorCheck(dialogue_event_instance->start());
+		if (e == 1) 
+		{
+			dialogue_event_instance->setUserData(nullptr);
+			audio_engine->m_alloc_dialogue_user_data.erase(id);
+			delete dialogue_user_data;
+			dialogue_user_data = nullptr;
+			return 0; 
+		}
+
+		audio_engine->m_level_meters.addEvent(id, dialogue_event_instance);
+
+		return id;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+unsigned long int FmodWrapper::playDialogue2D(const std::string key, DialogueMasterEvents master_event, std::map<std::string, float> parameters)
+{	
+	if (!audio_engine_initialized) { return 0; }
+
+	unsigned long int id = playDialogue2DInternal(key, master_event, parameters);
+	if (call_recorder != nullptr) { call_recorder->recordPlayDialogue2D(key, master_event, parameters, id); }
+	return id;
+}
+
+unsigned long int FmodWrapper::playDialogue2DInternal(const std::string& key, DialogueMasterEvents master_event, const std::map<std::string, float>& parameters)
+{
+	std::string dialogue_master_event;
+
+	switch (master_event)
+	{
+	case PC:
+		dialogue_master_event = "event:/PC_Dialogue_Master";
+		break;
+	case NPC:
+		dialogue_master_event = "event:/NPC_Dialogue_Master";
+		break;
+	default:
+		return 0;
+	}
+
+	FMOD::Studio::EventDescription* dialogue_event_description = audio_engine->getEventDescription(dialogue_master_event);
+	if (dialogue_event_description == nullptr) { return 0; }
+
+	FMOD::Studio::EventInstance* dialogue_event_instance = nullptr;
+	int e = errorCheck(dialogue_event_description->createInstance(&dialogue_event_instance));
+	if (e == 1) { return 0; }
+
+	if (!parameters.empty())
+	{
+		for (auto it = parameters.begin(); it != parameters.end(); it++)
+		{
+			std::string parameter = it->first;
+			float value = it->second;
+			errorCheck(dialogue_event_instance->setParameterByName(parameter.c_str(), value, false));
+		}
+	}
+
+	if (id_system != nullptr)
+	{
+		unsigned long int id = id_system->getUniqueId();
+		audio_engine->m_events.insert(std::pair<unsigned long int, FMOD::Studio::EventInstance*>(id, dialogue_event_instance));
+
+		dialogue_event_instance->setCallback(dialogueEventCallback, 
+								             FMOD_STUDIO_EVENT_CALLBACK_CREATE_PROGRAMMER_SOUND | 
+											 FMOD_STUDIO_EVENT_CALLBACK_DESTROY_PROGRAMMER_SOUND | 
+											 FMOD_STUDIO_EVENT_CALLBACK_STOPPED |
+											 FMOD_STUDIO_EVENT_CALLBACK_DESTROYED);
+
+		DialogueUserData* dialogue_user_data = new DialogueUserData();
+		dialogue_user_data->is_3d = false;
+		dialogue_user_data->line_key = key;
+		dialogue_user_data->associated_event_id = id;
+		dialogue_user_data->callbacks.event_id = id;
+		dialogue_user_data->callbacks.instance = dialogue_event_instance;
+		audio_engine->m_alloc_dialogue_user_data.insert(std::pair<unsigned long int, DialogueUserData*>(id, dialogue_user_data));
+
+		e = errorCheck(dialogue_event_instance->setUserData(dialogue_user_data));
+		if (e == 1)
+		{
+			audio_engine->m_alloc_dialogue_user_data.erase(id);
+			delete dialogue_user_data;
+			dialogue_user_data = nullptr;
+			return 0;
+		}
+
+		e = errorCheck(dialogue_event_instance->start());
+		if (e == 1)
+		{
+			dialogue_event_instance->setUserData(nullptr);
+			audio_engine->m_alloc_dialogue_user_data.erase(id);
+			delete dialogue_user_data;
+			dialogue_user_data = nullptr;
+			return 0;
+		}
+
+		audio_engine->m_level_meters.addEvent(id, dialogue_event_instance);
+		return id;
+	}
+	else
+	{
+		return 0;
+	}	
+}
+
+DialogueSoundStats FmodWrapper::getDialogueSoundStats()
+{
+	DialogueSoundStats stats;
+	if (!audio_engine_initialized) { return stats; }
+
+	stats.open_streams = audio_engine->m_open_dialogue_streams.load(std::memory_order_relaxed);
+	stats.peak_open_streams = audio_engine->m_peak_dialogue_streams.load(std::memory_order_relaxed);
+	stats.max_streams = audio_engine->m_dialogue_sound_settings.max_streams;
+	stats.streams_opened = audio_engine->m_dialogue_streams_opened.load(std::memory_order_relaxed);
+	stats.samples_created = audio_engine->m_dialogue_samples_created.load(std::memory_order_relaxed);
+	stats.stream_pool_fallbacks = audio_engine->m_dialogue_stream_fallbacks.load(std::memory_order_relaxed);
+	stats.sample_bytes = audio_engine->m_dialogue_sample_bytes.load(std::memory_order_relaxed);
+	stats.peak_sample_bytes = audio_engine->m_peak_dialogue_sample_bytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+float FmodWrapper::getDialogueEnvelope(int event_id)
+{
+	if (!audio_engine_initialized) { return 0.0f; }
+
+	const MeterReading* reading = audio_engine->m_level_meters.getReading(event_id);
+	if (reading == nullptr) { return 0.0f; }
+	return reading->envelope;
+}
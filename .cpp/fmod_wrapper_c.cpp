@@ -0,0 +1,163 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include "fmod_wrapper_c.h"
+#include "fmod_wrapper.h"
+
+// The wrapper's own state lives behind the static engine, so one instance serves every C call.
+static FmodWrapper c_wrapper;
+static std::unordered_map<uint32_t, std::string> c_names;
+static std::map<std::string, float> c_no_parameters;
+
+static FMOD_3D_ATTRIBUTES commandAttributes(const FW_COMMAND& command)
+{
+	FMOD_3D_ATTRIBUTES attributes;
+	attributes.position = { command.position[0], command.position[1], command.position[2] };
+	attributes.velocity = { command.velocity[0], command.velocity[1], command.velocity[2] };
+	attributes.forward = { command.forward[0], command.forward[1], command.forward[2] };
+	attributes.up = { command.up[0], command.up[1], command.up[2] };
+	return attributes;
+}
+
+static std::string* findName(uint32_t hash)
+{
+	auto find_key = c_names.find(hash);
+	if (find_key == c_names.end()) { return nullptr; }
+	return &find_key->second;
+}
+
+extern "C" {
+
+void fw_initialize(int non_realtime_output, int num_listeners)
+{
+	AudioEngineSettings settings;
+	settings.non_realtime_output = non_realtime_output != 0;
+	settings.num_listeners = num_listeners;
+	FmodWrapper::initializeAudioEngine(settings);
+}
+
+void fw_update(void)
+{
+	FmodWrapper::callUpdate();
+}
+
+void fw_shutdown(void)
+{
+	FmodWrapper::shutDownAudioEngine();
+	c_names.clear();
+}
+
+int fw_load_bank(const char* bank, int load_samples)
+{
+	if (bank == nullptr) { return 0; }
+	return c_wrapper.loadBank(bank, load_samples != 0);
+}
+
+int fw_unload_bank(const char* bank)
+{
+	if (bank == nullptr) { return 0; }
+	return c_wrapper.unloadBank(bank);
+}
+
+uint32_t fw_hash_name(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	if (name == nullptr) { return 0; }
+
+	for (const unsigned char* c = (const unsigned char*)name; *c != '\0'; c++)
+	{
+		hash ^= *c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+uint32_t fw_register_name(const char* name)
+{
+	uint32_t hash = fw_hash_name(name);
+	if (hash == 0) { return 0; }
+
+	auto find_key = c_names.find(hash);
+	if (find_key != c_names.end())
+	{
+		// Registering the same name again is fine, a different name with the same hash is not.
+		return find_key->second == name ? hash : 0;
+	}
+
+	c_names[hash] = name;
+	return hash;
+}
+
+int fw_execute(const FW_COMMAND* commands, int count, uint64_t* results)
+{
+	if (commands == nullptr || count <= 0) { return 0; }
+
+	int succeeded = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		const FW_COMMAND& command = commands[i];
+		uint64_t result = 0;
+
+		uint64_t handle = command.handle;
+		if ((command.flags & FW_FLAG_HANDLE_FROM_RESULT) != 0)
+		{
+			// Only earlier commands of this buffer can be referred to.
+			handle = (results != nullptr && handle < (uint64_t)i) ? results[handle] : 0;
+		}
+
+		bool enable = (command.flags & FW_FLAG_ENABLE) != 0;
+		std::string* name = findName(command.name_hash);
+
+		switch (command.type)
+		{
+			case FW_CMD_PLAY_3D:
+				if (name != nullptr) { result = c_wrapper.play3DEvent(*name, commandAttributes(command), c_no_parameters); }
+				break;
+			case FW_CMD_PLAY_2D:
+				if (name != nullptr) { result = c_wrapper.play2DEvent(*name, c_no_parameters); }
+				break;
+			case FW_CMD_STOP:
+				result = c_wrapper.stopEvent((int)handle, enable);
+				break;
+			case FW_CMD_SET_3D_ATTRIBUTES:
+				result = c_wrapper.set3DAttributes((int)handle, commandAttributes(command));
+				break;
+			case FW_CMD_SET_PARAMETER:
+			{
+				std::string* parameter = findName(command.parameter_hash);
+				if (parameter != nullptr) { result = c_wrapper.setParameterByName((int)handle, *parameter, command.value); }
+				break;
+			}
+			case FW_CMD_SET_GLOBAL_PARAMETER:
+				if (name != nullptr) { result = c_wrapper.setGlobalParameterByName(*name, command.value); }
+				break;
+			case FW_CMD_SET_LISTENER_ATTRIBUTES:
+				result = FmodWrapper::setListenerAttributes((int)handle, commandAttributes(command));
+				break;
+			case FW_CMD_SET_BUS_PAUSED:
+				if (name != nullptr) { result = c_wrapper.setBusPauseStatus(*name, enable); }
+				break;
+			case FW_CMD_STOP_BUS_EVENTS:
+				if (name != nullptr) { result = c_wrapper.stopAllBusEvents(*name, enable); }
+				break;
+			case FW_CMD_SET_BUS_VOLUME:
+				if (name != nullptr) { result = c_wrapper.setBusVolume(*name, command.value, command.fade_seconds); }
+				break;
+			case FW_CMD_SET_VCA_VOLUME:
+				if (name != nullptr) { result = c_wrapper.setVCAVolume(*name, command.value, command.fade_seconds); }
+				break;
+			default:
+				break;
+		}
+
+		if (results != nullptr) { results[i] = result; }
+		if (result != 0) { succeeded++; }
+	}
+	return succeeded;
+}
+
+}
@@ -0,0 +1,212 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cmath>
+#include "level_meters.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LEVEL_METERS_SSE
+#endif
+
+LevelMeters::LevelMeters()
+{
+	m_attack_seconds = 0.01f;
+	m_release_seconds = 0.15f;
+}
+
+int LevelMeters::addBus(unsigned long int id, FMOD::Studio::Bus* bus)
+{
+	if (contains(id) || bus == nullptr) { return 0; }
+	if (bus->lockChannelGroup() != FMOD_OK) { return 0; }
+
+	Source source;
+	source.bus = bus;
+	source.instance = nullptr;
+	source.dsp = nullptr;
+
+	m_index[id] = m_sources.size();
+	m_sources.push_back(source);
+
+	MeterReading reading;
+	reading.id = id;
+	m_readings.push_back(reading);
+	m_power.push_back(0.0f);
+	m_inverse_channels.push_back(0.0f);
+	m_rms.push_back(0.0f);
+	m_envelope.push_back(0.0f);
+	return 1;
+}
+
+int LevelMeters::addEvent(unsigned long int id, FMOD::Studio::EventInstance* instance)
+{
+	if (contains(id) || instance == nullptr) { return 0; }
+
+	Source source;
+	source.bus = nullptr;
+	source.instance = instance;
+	source.dsp = nullptr;
+
+	m_index[id] = m_sources.size();
+	m_sources.push_back(source);
+
+	MeterReading reading;
+	reading.id = id;
+	m_readings.push_back(reading);
+	m_power.push_back(0.0f);
+	m_inverse_channels.push_back(0.0f);
+	m_rms.push_back(0.0f);
+	m_envelope.push_back(0.0f);
+	return 1;
+}
+
+int LevelMeters::remove(unsigned long int id)
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return 0; }
+
+	size_t index = find_key->second;
+	if (m_sources[index].bus != nullptr && m_sources[index].bus->isValid()) { m_sources[index].bus->unlockChannelGroup(); }
+
+	size_t last = m_sources.size() - 1;
+	if (index != last)
+	{
+		m_sources[index] = m_sources[last];
+		m_readings[index] = m_readings[last];
+		m_power[index] = m_power[last];
+		m_inverse_channels[index] = m_inverse_channels[last];
+		m_rms[index] = m_rms[last];
+		m_envelope[index] = m_envelope[last];
+		m_index[m_readings[index].id] = index;
+	}
+	m_sources.pop_back();
+	m_readings.pop_back();
+	m_power.pop_back();
+	m_inverse_channels.pop_back();
+	m_rms.pop_back();
+	m_envelope.pop_back();
+	m_index.erase(id);
+	return 1;
+}
+
+void LevelMeters::setSmoothing(float attack_seconds, float release_seconds)
+{
+	m_attack_seconds = attack_seconds < 0.0f ? 0.0f : attack_seconds;
+	m_release_seconds = release_seconds < 0.0f ? 0.0f : release_seconds;
+}
+
+const MeterReading* LevelMeters::getReadings(int& count) const
+{
+	count = (int)m_readings.size();
+	return m_readings.empty() ? nullptr : m_readings.data();
+}
+
+const MeterReading* LevelMeters::getReading(unsigned long int id) const
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return nullptr; }
+	return &m_readings[find_key->second];
+}
+
+FMOD::DSP* LevelMeters::resolveDSP(Source& source)
+{
+	FMOD::ChannelGroup* channel_group = nullptr;
+
+	if (source.bus != nullptr)
+	{
+		// A locked bus keeps its channel group, so the DSP only has to be looked up once. It becomes available one update after locking.
+		if (!source.bus->isValid()) { source.dsp = nullptr; return nullptr; }
+		if (source.dsp != nullptr) { return source.dsp; }
+		if (source.bus->getChannelGroup(&channel_group) != FMOD_OK) { return nullptr; }
+	}
+	else
+	{
+		// An event's channel group only exists while it is playing, so it is looked up every update.
+		source.dsp = nullptr;
+		if (!source.instance->isValid()) { return nullptr; }
+		if (source.instance->getChannelGroup(&channel_group) != FMOD_OK) { return nullptr; }
+	}
+
+	FMOD::DSP* dsp = nullptr;
+	if (channel_group->getDSP(FMOD_CHANNELCONTROL_DSP_HEAD, &dsp) != FMOD_OK) { return nullptr; }
+	if (dsp->setMeteringEnabled(false, true) != FMOD_OK) { return nullptr; }
+
+	source.dsp = dsp;
+	return dsp;
+}
+
+void LevelMeters::computeLevels(float attack_coefficient, float release_coefficient)
+{
+	size_t count = m_sources.size();
+	size_t i = 0;
+
+#ifdef LEVEL_METERS_SSE
+	__m128 attack = _mm_set1_ps(attack_coefficient);
+	__m128 release = _mm_set1_ps(release_coefficient);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 rms = _mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(&m_power[i]), _mm_loadu_ps(&m_inverse_channels[i])));
+		__m128 envelope = _mm_loadu_ps(&m_envelope[i]);
+
+		// Attack coefficient where the level rises, release coefficient where it falls.
+		__m128 rising = _mm_cmpgt_ps(rms, envelope);
+		__m128 coefficient = _mm_or_ps(_mm_and_ps(rising, attack), _mm_andnot_ps(rising, release));
+		envelope = _mm_add_ps(envelope, _mm_mul_ps(coefficient, _mm_sub_ps(rms, envelope)));
+
+		_mm_storeu_ps(&m_rms[i], rms);
+		_mm_storeu_ps(&m_envelope[i], envelope);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float rms = std::sqrt(m_power[i] * m_inverse_channels[i]);
+		float coefficient = rms > m_envelope[i] ? attack_coefficient : release_coefficient;
+		m_rms[i] = rms;
+		m_envelope[i] += coefficient * (rms - m_envelope[i]);
+	}
+}
+
+void LevelMeters::update(float delta_time)
+{
+	if (m_sources.empty()) { return; }
+
+	// 1. Gather: sum of squared channel RMS levels and the channel peak of each meter.
+	for (size_t i = 0; i < m_sources.size(); i++)
+	{
+		m_power[i] = 0.0f;
+		m_inverse_channels[i] = 0.0f;
+		m_readings[i].peak = 0.0f;
+
+		FMOD::DSP* dsp = resolveDSP(m_sources[i]);
+		if (dsp == nullptr) { continue; }
+
+		FMOD_DSP_METERING_INFO info;
+		if (dsp->getMeteringInfo(nullptr, &info) != FMOD_OK || info.numchannels <= 0) { continue; }
+
+		int channels = info.numchannels > 32 ? 32 : info.numchannels;
+		float power = 0.0f;
+		float peak = 0.0f;
+		for (int c = 0; c < channels; c++)
+		{
+			power += info.rmslevel[c] * info.rmslevel[c];
+			if (info.peaklevel[c] > peak) { peak = info.peaklevel[c]; }
+		}
+		m_power[i] = power;
+		m_inverse_channels[i] = 1.0f / (float)channels;
+		m_readings[i].peak = peak;
+	}
+
+	// 2. RMS and envelopes for all meters in one pass.
+	float attack_coefficient = m_attack_seconds > 0.0f ? 1.0f - std::exp(-delta_time / m_attack_seconds) : 1.0f;
+	float release_coefficient = m_release_seconds > 0.0f ? 1.0f - std::exp(-delta_time / m_release_seconds) : 1.0f;
+	computeLevels(attack_coefficient, release_coefficient);
+
+	// 3. Publish.
+	for (size_t i = 0; i < m_readings.size(); i++)
+	{
+		m_readings[i].rms = m_rms[i];
+		m_readings[i].envelope = m_envelope[i];
+	}
+}
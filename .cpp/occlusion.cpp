@@ -0,0 +1,226 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include "occlusion.h"
+
+// Smoothed values closer than this to the last written one are not sent to FMOD again.
+static const float apply_epsilon = 0.001f;
+
+OcclusionStage::OcclusionStage()
+{
+	m_callback = nullptr;
+	m_callback_user_data = nullptr;
+}
+
+int OcclusionStage::add(unsigned long int id, FMOD::Studio::EventInstance* instance, const std::string& parameter)
+{
+	if (contains(id) || instance == nullptr) { return 0; }
+
+	Emitter emitter;
+	emitter.id = id;
+	emitter.instance = instance;
+	emitter.use_parameter = !parameter.empty();
+	emitter.target = 0.0f;
+	emitter.smoothed = 0.0f;
+	emitter.applied = 0.0f;
+	emitter.wait = 0.0f;
+
+	// The parameter is resolved once here, the per-update writes go by ID.
+	if (emitter.use_parameter)
+	{
+		FMOD::Studio::EventDescription* description = nullptr;
+		FMOD_STUDIO_PARAMETER_DESCRIPTION parameter_description;
+		if (instance->getDescription(&description) != FMOD_OK) { return 0; }
+		if (description->getParameterDescriptionByName(parameter.c_str(), &parameter_description) != FMOD_OK) { return 0; }
+		emitter.parameter_id = parameter_description.id;
+	}
+
+	FMOD_3D_ATTRIBUTES attributes;
+	if (instance->get3DAttributes(&attributes) != FMOD_OK) { return 0; }
+	emitter.position = attributes.position;
+
+	m_index[id] = m_emitters.size();
+	m_emitters.push_back(emitter);
+	m_stats.emitters = (unsigned long int)m_emitters.size();
+	return 1;
+}
+
+int OcclusionStage::remove(unsigned long int id)
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return 0; }
+
+	size_t index = find_key->second;
+	if (index != m_emitters.size() - 1)
+	{
+		m_emitters[index] = m_emitters.back();
+		m_index[m_emitters[index].id] = index;
+	}
+	m_emitters.pop_back();
+	m_index.erase(id);
+	m_stats.emitters = (unsigned long int)m_emitters.size();
+	return 1;
+}
+
+void OcclusionStage::setPosition(unsigned long int id, const FMOD_VECTOR& position)
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return; }
+	m_emitters[find_key->second].position = position;
+}
+
+void OcclusionStage::setQuery(OcclusionQueryCallback callback, void* user_data)
+{
+	m_callback = callback;
+	m_callback_user_data = user_data;
+}
+
+float OcclusionStage::getOcclusion(unsigned long int id) const
+{
+	auto find_key = m_index.find(id);
+	if (find_key == m_index.end()) { return -1.0f; }
+	return m_emitters[find_key->second].smoothed;
+}
+
+void OcclusionStage::gatherCandidates(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners)
+{
+	m_candidates.clear();
+	const float max_distance_sq = m_settings.max_distance * m_settings.max_distance;
+
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		const Emitter& emitter = m_emitters[i];
+		if (emitter.wait < m_settings.min_interval_seconds) { continue; }
+
+		int closest = -1;
+		float closest_sq = 0.0f;
+		for (int l = 0; l < num_listeners; l++)
+		{
+			float dx = emitter.position.x - listeners[l].position.x;
+			float dy = emitter.position.y - listeners[l].position.y;
+			float dz = emitter.position.z - listeners[l].position.z;
+			float distance_sq = dx * dx + dy * dy + dz * dz;
+			if (closest == -1 || distance_sq < closest_sq)
+			{
+				closest = l;
+				closest_sq = distance_sq;
+			}
+		}
+		if (closest == -1 || closest_sq > max_distance_sq) { continue; }
+
+		// Audibility already includes the event's volume and distance attenuation. It is not available before the event's channel group exists.
+		float audibility = 0.0f;
+		FMOD::ChannelGroup* channel_group = nullptr;
+		if (emitter.instance->getChannelGroup(&channel_group) == FMOD_OK) { channel_group->getAudibility(&audibility); }
+
+		// Waiting time keeps every emitter in rotation, distance and loudness decide who goes first.
+		Candidate candidate;
+		candidate.index = i;
+		candidate.listener = closest;
+		candidate.score = emitter.wait * (0.1f + audibility) / (1.0f + std::sqrt(closest_sq) / m_settings.max_distance * 4.0f);
+		m_candidates.push_back(candidate);
+	}
+}
+
+void OcclusionStage::query()
+{
+	int count = (int)m_rays.size();
+	if (count == 0) { return; }
+
+	m_results.assign(count, 0.0f);
+
+	auto start = std::chrono::steady_clock::now();
+	m_callback(m_rays.data(), count, m_results.data(), m_callback_user_data);
+	double query_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	m_stats.query_ms_last_update = query_ms;
+	if (query_ms > m_stats.query_ms_max) { m_stats.query_ms_max = query_ms; }
+}
+
+void OcclusionStage::apply(Emitter& emitter)
+{
+	if (std::fabs(emitter.smoothed - emitter.applied) < apply_epsilon) { return; }
+
+	if (emitter.use_parameter)
+	{
+		// Already smoothed here, so the parameter's own seek speed is skipped.
+		if (emitter.instance->setParameterByID(emitter.parameter_id, emitter.smoothed, true) != FMOD_OK) { return; }
+	}
+	else
+	{
+		// The channel group only exists while the event is playing.
+		FMOD::ChannelGroup* channel_group = nullptr;
+		if (emitter.instance->getChannelGroup(&channel_group) != FMOD_OK) { return; }
+		float gain = 1.0f - emitter.smoothed * (1.0f - m_settings.lowpass_min_gain);
+		if (channel_group->setLowPassGain(gain) != FMOD_OK) { return; }
+	}
+	emitter.applied = emitter.smoothed;
+}
+
+void OcclusionStage::update(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners, float delta_time)
+{
+	m_stats.candidates_last_update = 0;
+	m_stats.rays_last_update = 0;
+	m_stats.query_ms_last_update = 0.0;
+	m_stats.average_wait_last_update = 0.0f;
+
+	if (m_emitters.empty()) { return; }
+
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		m_emitters[i].wait += delta_time;
+	}
+
+	// 1. Pick the emitters that get a ray this update.
+	m_rays.clear();
+	if (m_callback != nullptr && num_listeners > 0 && m_settings.max_rays_per_update > 0)
+	{
+		gatherCandidates(listeners, num_listeners);
+		m_stats.candidates_last_update = (unsigned long int)m_candidates.size();
+
+		size_t budget = std::min((size_t)m_settings.max_rays_per_update, m_candidates.size());
+		if (budget < m_candidates.size())
+		{
+			std::nth_element(m_candidates.begin(), m_candidates.begin() + budget, m_candidates.end(),
+							 [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+		}
+
+		for (size_t c = 0; c < budget; c++)
+		{
+			const Emitter& emitter = m_emitters[m_candidates[c].index];
+			OcclusionRay ray;
+			ray.emitter_id = emitter.id;
+			ray.from = listeners[m_candidates[c].listener].position;
+			ray.to = emitter.position;
+			m_rays.push_back(ray);
+		}
+	}
+
+	// 2. One batched query for all of them.
+	query();
+
+	float total_wait = 0.0f;
+	for (size_t r = 0; r < m_rays.size(); r++)
+	{
+		Emitter& emitter = m_emitters[m_candidates[r].index];
+		float result = m_results[r];
+		emitter.target = result < 0.0f ? 0.0f : (result > 1.0f ? 1.0f : result);
+		total_wait += emitter.wait;
+		emitter.wait = 0.0f;
+	}
+	m_stats.rays_last_update = (unsigned long int)m_rays.size();
+	m_stats.rays_total += m_rays.size();
+	if (!m_rays.empty()) { m_stats.average_wait_last_update = total_wait / (float)m_rays.size(); }
+
+	// 3. Smooth towards the latest results and write the ones that changed.
+	float coefficient = m_settings.smoothing_seconds > 0.0f ? 1.0f - std::exp(-delta_time / m_settings.smoothing_seconds) : 1.0f;
+	for (size_t i = 0; i < m_emitters.size(); i++)
+	{
+		Emitter& emitter = m_emitters[i];
+		emitter.smoothed += coefficient * (emitter.target - emitter.smoothed);
+		apply(emitter);
+	}
+}
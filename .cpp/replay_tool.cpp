@@ -0,0 +1,44 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include "fmod_wrapper.h"
+#include "call_recorder.h"
+
+// Replays a capture log written with FmodWrapper::startCapture, so that audio hot spots from a QA session can be profiled offline.
+// Usage: replay_tool <capture file> [--realtime]
+// Runs against non-realtime output by default, i.e. as fast as the wrapper can process the calls.
+// Built from the wrapper sources and this file, without main.cpp (see README.md).
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "Usage: replay_tool <capture file> [--realtime]" << std::endl;
+		return 1;
+	}
+
+	std::string capture_path = argv[1];
+	bool real_time = argc > 2 && std::string(argv[2]) == "--realtime";
+
+	AudioEngineSettings settings;
+	settings.non_realtime_output = !real_time;
+	FmodWrapper::initializeAudioEngine(settings);
+
+	FmodWrapper fmod_wrapper;
+	CallReplayer replayer;
+	ReplayStats stats;
+
+	int r = replayer.replay(capture_path, fmod_wrapper, real_time ? CallReplayer::real_time : CallReplayer::full_speed, &stats);
+	if (r == 0) { std::cout << "Capture log could not be fully replayed: " << capture_path << std::endl; }
+
+	std::cout << "Frames: " << stats.frames << ", calls: " << stats.calls << std::endl;
+	std::cout << "Total update time: " << stats.total_update_ms << " ms" << std::endl;
+	if (stats.frames > 0)
+	{
+		std::cout << "Average update time: " << stats.total_update_ms / stats.frames << " ms" << std::endl;
+	}
+	std::cout << "Worst update: " << stats.worst_update_ms << " ms (frame " << stats.worst_update_frame << ")" << std::endl;
+
+	FmodWrapper::shutDownAudioEngine();
+	return r == 1 ? 0 : 1;
+}
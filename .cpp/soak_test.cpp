@@ -0,0 +1,308 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <algorithm>
+#include "fmod_wrapper.h"
+
+// Headless soak test: drives a randomized play / stop / parameter / dialogue / bus / bank workload against non-realtime output
+// for a number of simulated hours, and fails if FMOD's memory, the wrapper's containers or the update cost keep growing.
+// Usage: soak_test [simulated hours] [seed] [--verbose]
+// Replace the FMOD Studio project specific fields below with your own data, as in main.cpp.
+// Built from the wrapper sources and this file, without main.cpp (see README.md).
+
+static const std::string extra_bank = "D:/FmodTestProject/Build/Desktop/Samples.bank";
+static const std::string dialogue_bank = "D:/FmodTestProject/Build/Desktop/Voiceovers_EN.bank";
+static const std::vector<std::string> events_3d = { "event:/Footsteps", "event:/Ambience/Fire", "event:/Weapons/Explosion" };
+static const std::vector<std::string> events_2d = { "event:/UI/Click", "event:/Music/Level_01" };
+static const std::vector<std::string> dialogue_keys = { "welcome", "goodbye", "cutscene_intro" };
+static const std::vector<std::string> buses = { "bus:/SFX", "bus:/Music" };
+static const std::string snapshot = "snapshot:/Underwater";
+static std::string parameter = "Intensity";
+
+static const int ticks_per_second = 60;
+static const int sample_interval_seconds = 60;
+
+// Event handles kept alive by the workload. Older ones are stopped when the limit is reached, so a leak free wrapper plateaus.
+static const size_t max_live_events = 64;
+
+struct SoakSample
+{
+	double simulated_seconds = 0.0;
+	int fmod_current_bytes = 0;
+	WrapperDiagnostics diagnostics;
+	double update_ms_average = 0.0;
+	double update_ms_max = 0.0;
+};
+
+class SoakWorkload
+{
+public:
+
+	SoakWorkload(unsigned int seed) : m_random(seed), m_extra_bank_loaded(false), m_snapshot_request(0) {}
+
+	void tick(FmodWrapper& fmod_wrapper, double simulated_seconds)
+	{
+		// A listener slowly circling the origin, so that distance based logic keeps changing.
+		FMOD_3D_ATTRIBUTES listener = attributes(0.0f);
+		listener.position = { 20.0f * std::cos((float)simulated_seconds * 0.1f), 0.0f, 20.0f * std::sin((float)simulated_seconds * 0.1f) };
+		FmodWrapper::setListenerAttributes(0, listener);
+
+		if (chance(0.3f)) { remember(fmod_wrapper, fmod_wrapper.play3DEvent(pick(events_3d), attributes(50.0f))); }
+		if (chance(0.1f)) { remember(fmod_wrapper, fmod_wrapper.play2DEvent(pick(events_2d))); }
+		if (chance(0.02f))
+		{
+			unsigned long int id = chance(0.5f) ? fmod_wrapper.playDialogue3D(pick(dialogue_keys), FmodWrapper::NPC, attributes(30.0f))
+												: fmod_wrapper.playDialogue2D(pick(dialogue_keys), FmodWrapper::PC);
+			remember(fmod_wrapper, id);
+		}
+
+		if (!m_live.empty())
+		{
+			if (chance(0.25f))
+			{
+				size_t index = m_random() % m_live.size();
+				fmod_wrapper.stopEvent((int)m_live[index], chance(0.5f));
+				m_live[index] = m_live.back();
+				m_live.pop_back();
+			}
+
+			if (!m_live.empty() && chance(0.5f)) { fmod_wrapper.setParameterByName((int)pick(m_live), parameter, uniform(0.0f, 1.0f)); }
+			if (!m_live.empty() && chance(0.5f)) { fmod_wrapper.set3DAttributes((int)pick(m_live), attributes(50.0f)); }
+		}
+
+		if (chance(0.005f)) { fmod_wrapper.setBusPauseStatus(pick(buses), chance(0.5f)); }
+		if (chance(0.01f)) { fmod_wrapper.setBusVolume(pick(buses), uniform(0.0f, 1.0f), uniform(0.0f, 2.0f)); }
+
+		if (chance(0.005f))
+		{
+			if (m_snapshot_request == 0) { m_snapshot_request = fmod_wrapper.activateSnapshot(snapshot, uniform(0.0f, 100.0f), 0, 1.0f); }
+			else
+			{
+				fmod_wrapper.releaseSnapshot(m_snapshot_request, 1.0f);
+				m_snapshot_request = 0;
+			}
+		}
+
+		// About every 30 simulated seconds.
+		if (chance(1.0f / (30.0f * ticks_per_second)))
+		{
+			if (m_extra_bank_loaded) { fmod_wrapper.unloadBank(extra_bank); }
+			else { fmod_wrapper.loadBank(extra_bank, chance(0.5f)); }
+			m_extra_bank_loaded = !m_extra_bank_loaded;
+		}
+	}
+
+	// Leaves nothing playing or requested, so that the wrapper's containers can be checked for leftovers.
+	void drain(FmodWrapper& fmod_wrapper)
+	{
+		for (size_t i = 0; i < m_live.size(); i++)
+		{
+			fmod_wrapper.stopEvent((int)m_live[i], false);
+		}
+		m_live.clear();
+
+		for (size_t i = 0; i < buses.size(); i++)
+		{
+			fmod_wrapper.setBusPauseStatus(buses[i], false);
+			fmod_wrapper.stopAllBusEvents(buses[i], false);
+		}
+
+		if (m_snapshot_request != 0)
+		{
+			fmod_wrapper.releaseSnapshot(m_snapshot_request);
+			m_snapshot_request = 0;
+		}
+
+		if (m_extra_bank_loaded)
+		{
+			fmod_wrapper.unloadBank(extra_bank);
+			m_extra_bank_loaded = false;
+		}
+	}
+
+private:
+
+	std::mt19937 m_random;
+	std::vector<unsigned long int> m_live;
+	bool m_extra_bank_loaded;
+	unsigned long int m_snapshot_request;
+
+	bool chance(float probability) { return uniform(0.0f, 1.0f) < probability; }
+	float uniform(float min, float max) { return std::uniform_real_distribution<float>(min, max)(m_random); }
+
+	template <typename T>
+	const T& pick(const std::vector<T>& values) { return values[m_random() % values.size()]; }
+
+	FMOD_3D_ATTRIBUTES attributes(float range)
+	{
+		FMOD_3D_ATTRIBUTES attributes;
+		attributes.position = { uniform(-range, range), 0.0f, uniform(-range, range) };
+		attributes.velocity = { 0.0f, 0.0f, 0.0f };
+		attributes.forward = { 0.0f, 0.0f, 1.0f };
+		attributes.up = { 0.0f, 1.0f, 0.0f };
+		return attributes;
+	}
+
+	void remember(FmodWrapper& fmod_wrapper, unsigned long int id)
+	{
+		if (id == 0) { return; }
+		if (m_live.size() >= max_live_events)
+		{
+			fmod_wrapper.stopEvent((int)m_live.front(), true);
+			m_live.erase(m_live.begin());
+		}
+		m_live.push_back(id);
+	}
+};
+
+static double average(const std::vector<SoakSample>& samples, size_t begin, size_t end, double (*value)(const SoakSample&))
+{
+	double sum = 0.0;
+	for (size_t i = begin; i < end; i++)
+	{
+		sum += value(samples[i]);
+	}
+	return end > begin ? sum / (double)(end - begin) : 0.0;
+}
+
+struct GrowthCheck
+{
+	const char* name;
+	double (*value)(const SoakSample&);
+	// Growth allowed between the first and the last third of the run, absolute and relative to the first third.
+	double absolute_tolerance;
+	double relative_tolerance;
+};
+
+static const GrowthCheck growth_checks[] =
+{
+	{ "FMOD memory (bytes)", [](const SoakSample& s) { return (double)s.fmod_current_bytes; }, 1024.0 * 1024.0, 0.05 },
+	{ "events", [](const SoakSample& s) { return (double)s.diagnostics.events; }, 8.0, 0.25 },
+	{ "dialogue user data", [](const SoakSample& s) { return (double)s.diagnostics.dialogue_user_data; }, 4.0, 0.25 },
+	{ "event callback data", [](const SoakSample& s) { return (double)s.diagnostics.event_callback_data; }, 4.0, 0.25 },
+	{ "staged writes", [](const SoakSample& s) { return (double)s.diagnostics.staged_writes; }, 8.0, 0.25 },
+	{ "event descriptions", [](const SoakSample& s) { return (double)s.diagnostics.event_descriptions; }, 4.0, 0.25 },
+	{ "update cost (ms)", [](const SoakSample& s) { return s.update_ms_average; }, 0.05, 0.5 }
+};
+
+// Compares the first and the last third of the samples after warm-up. A leak free wrapper under a bounded workload plateaus.
+static bool checkGrowth(const std::vector<SoakSample>& samples, std::ostream& report)
+{
+	size_t warm_up = std::max((size_t)2, samples.size() / 10);
+	if (samples.size() < warm_up + 3)
+	{
+		report << "Too few samples for growth checks, run for longer." << std::endl;
+		return true;
+	}
+
+	size_t third = (samples.size() - warm_up) / 3;
+	bool passed = true;
+
+	for (const GrowthCheck& check : growth_checks)
+	{
+		double first = average(samples, warm_up, warm_up + third, check.value);
+		double last = average(samples, samples.size() - third, samples.size(), check.value);
+		bool grew = last - first > check.absolute_tolerance + first * check.relative_tolerance;
+
+		report << (grew ? "FAIL " : "ok   ") << check.name << ": " << first << " -> " << last << std::endl;
+		if (grew) { passed = false; }
+	}
+	return passed;
+}
+
+// Everything the workload started has been stopped, so the per-instance containers have to be empty again.
+static bool checkDrained(const WrapperDiagnostics& d, std::ostream& report)
+{
+	unsigned long int leftovers = d.events + d.dialogue_user_data + d.event_callback_data + d.deferred_plays + d.staged_writes + d.dirty_events +
+								  d.snapshot_requests + d.emitters + d.meters + d.occlusion_emitters + d.pending_bank_loads;
+
+	report << (leftovers != 0 ? "FAIL " : "ok   ") << "after drain: events " << d.events << ", dialogue user data " << d.dialogue_user_data
+		   << ", callback data " << d.event_callback_data << ", deferred plays " << d.deferred_plays << ", staged writes " << d.staged_writes
+		   << ", snapshot requests " << d.snapshot_requests << ", emitters " << d.emitters << ", meters " << d.meters << std::endl;
+	return leftovers == 0;
+}
+
+int main(int argc, char* argv[])
+{
+	double hours = argc > 1 ? std::atof(argv[1]) : 1.0;
+	unsigned int seed = argc > 2 ? (unsigned int)std::strtoul(argv[2], nullptr, 10) : 1;
+	bool verbose = argc > 3 && std::string(argv[3]) == "--verbose";
+
+	if (hours <= 0.0)
+	{
+		std::cout << "Usage: soak_test [simulated hours] [seed] [--verbose]" << std::endl;
+		return 1;
+	}
+
+	// The wrapper's debug prints would dominate a run of several hours.
+	std::ostream report(std::cout.rdbuf());
+	if (!verbose) { std::cout.rdbuf(nullptr); }
+
+	AudioEngineSettings settings;
+	settings.non_realtime_output = true;
+	FmodWrapper::initializeAudioEngine(settings);
+
+	FmodWrapper fmod_wrapper;
+	fmod_wrapper.loadBank(dialogue_bank, false);
+
+	SoakWorkload workload(seed);
+	std::vector<SoakSample> samples;
+
+	long long total_ticks = (long long)(hours * 3600.0 * ticks_per_second);
+	long long ticks_per_sample = (long long)sample_interval_seconds * ticks_per_second;
+	double window_ms = 0.0;
+	double window_max_ms = 0.0;
+
+	report << "Soaking " << hours << " simulated hours (" << total_ticks << " updates), seed " << seed << std::endl;
+
+	for (long long tick = 1; tick <= total_ticks; tick++)
+	{
+		double simulated_seconds = (double)tick / ticks_per_second;
+		workload.tick(fmod_wrapper, simulated_seconds);
+
+		auto start = std::chrono::steady_clock::now();
+		FmodWrapper::callUpdate();
+		double update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		window_ms += update_ms;
+		window_max_ms = std::max(window_max_ms, update_ms);
+
+		if (tick % ticks_per_sample != 0) { continue; }
+
+		SoakSample sample;
+		sample.simulated_seconds = simulated_seconds;
+		int max_bytes = 0;
+		FMOD::Memory_GetStats(&sample.fmod_current_bytes, &max_bytes, false);
+		sample.diagnostics = FmodWrapper::getDiagnostics();
+		sample.update_ms_average = window_ms / (double)ticks_per_sample;
+		sample.update_ms_max = window_max_ms;
+		samples.push_back(sample);
+		window_ms = 0.0;
+		window_max_ms = 0.0;
+
+		// One line per simulated 10 minutes.
+		if (samples.size() % 10 == 0)
+		{
+			report << (int)(simulated_seconds / 60.0) << " min: FMOD memory " << sample.fmod_current_bytes / 1024 << " KB, events " << sample.diagnostics.events
+				   << ", dialogue " << sample.diagnostics.dialogue_user_data << ", update avg " << sample.update_ms_average << " ms, max " << sample.update_ms_max << " ms" << std::endl;
+		}
+	}
+
+	// Stop everything and let the releases and fade-outs go through.
+	workload.drain(fmod_wrapper);
+	for (int i = 0; i < 10 * ticks_per_second; i++)
+	{
+		FmodWrapper::callUpdate();
+	}
+
+	bool passed = checkGrowth(samples, report);
+	passed = checkDrained(FmodWrapper::getDiagnostics(), report) && passed;
+
+	FmodWrapper::shutDownAudioEngine();
+	std::cout.rdbuf(report.rdbuf());
+
+	report << (passed ? "PASSED" : "FAILED") << std::endl;
+	return passed ? 0 : 1;
+}
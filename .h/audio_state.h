@@ -0,0 +1,56 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "fmod_studio.hpp"
+
+struct SavedParameter
+{
+	FMOD_STUDIO_PARAMETER_ID id;
+	float value;
+};
+
+// One playing event instance. Events are identified by GUID and parameters by ID, both of which stay the same across bank rebuilds.
+struct SavedEventState
+{
+	unsigned long int id = 0;
+	FMOD_GUID guid;
+	int timeline_position = 0;
+	bool is_3d = false;
+	FMOD_3D_ATTRIBUTES attributes;
+	bool paused = false;
+	bool emitter = false;
+	std::vector<SavedParameter> parameters;
+};
+
+struct SavedAudioState
+{
+	std::vector<SavedEventState> events;
+	std::vector<std::string> paused_buses;
+};
+
+// Binary encoding of a "SavedAudioState", for save games and level restarts. Counts and integers are varints, floats and IDs are stored raw.
+
+class AudioStateCodec
+{
+public:
+
+	static const unsigned int blob_magic = 0x53415746; // "FWAS"
+	static const unsigned int blob_version = 1;
+
+	static void encode(const SavedAudioState& state, std::vector<unsigned char>& blob);
+
+	// Returns 0 if the blob is truncated or not an audio state blob.
+	static int decode(const std::vector<unsigned char>& blob, SavedAudioState& state);
+
+private:
+
+	static void writeVarint(std::vector<unsigned char>& blob, unsigned long long value);
+	static void writeRaw(std::vector<unsigned char>& blob, const void* data, size_t size);
+	static bool readVarint(const std::vector<unsigned char>& blob, size_t& position, unsigned long long& value);
+	static bool readRaw(const std::vector<unsigned char>& blob, size_t& position, void* data, size_t size);
+};
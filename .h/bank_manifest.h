@@ -0,0 +1,33 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "fmod_studio.hpp"
+
+// Maps event paths and GUIDs to the bank files holding them. Can be built offline and saved to a text file, or grown at runtime as banks are loaded.
+// GUIDs are stored in the "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}" form that "getEvent" also accepts in place of a path.
+
+class BankManifest
+{
+public:
+
+	// Records every event of a loaded bank. Returns the number of events added.
+	int addBank(const std::string& bank_file, FMOD::Studio::Bank* bank);
+
+	// Returns null if the event is not in the manifest.
+	const std::string* findBank(const std::string& event) const;
+
+	int save(const std::string& file_path) const;
+	int load(const std::string& file_path);
+
+	size_t size() const { return m_event_to_bank.size(); }
+
+	static std::string guidToString(const FMOD_GUID& guid);
+
+private:
+
+	std::unordered_map<std::string, std::string> m_event_to_bank;
+};
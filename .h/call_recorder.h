@@ -0,0 +1,203 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include "fmod_studio.hpp"
+
+class FmodWrapper;
+struct StreamingZone;
+struct EmitterLodSettings;
+struct OcclusionSettings;
+struct EmitterClusterSettings;
+
+// Writes the public wrapper call stream into a compact binary log, so that a QA session can be replayed offline.
+// Strings (event paths, bus paths, parameter names...) are written once and then referenced by an index.
+// The frame number of each call is implied by the preceding update records. Calls that hand out an ID are recorded
+// after they return, together with the ID (0 if they failed), so that the replay can remap later calls to its own IDs.
+//
+// Not captured: anything taking a game side callback ("setOcclusionQuery", callback subscribers and subscriptions), the absolute
+// DSP clock schedule ("schedulePlayAtClock", "setScheduleLookahead"), whose clock times don't carry over to a replay, "buildBankManifest"
+// and "saveBankManifest", which only write files, and the read-only getters. The engine settings are the replay's own.
+// Plays scheduled relative to another event are captured, the replay schedules them against its own reference.
+
+class CallRecorder
+{
+public:
+
+	// The opcode values end up on disk, so only ever append new ones to the end.
+	enum CaptureOp
+	{
+		op_string,
+		op_update,
+		op_load_bank,
+		op_unload_bank,
+		op_load_sample_data,
+		op_unload_sample_data,
+		op_play_3d,
+		op_play_2d,
+		op_stop,
+		op_set_3d_attributes,
+		op_set_listener_attributes,
+		op_set_parameter,
+		op_set_global_parameter,
+		op_set_bus_paused,
+		op_stop_bus_events,
+		op_play_dialogue_3d,
+		op_play_dialogue_2d,
+		op_play_one_shot_3d,
+		op_play_one_shot_2d,
+		op_register_emitter,
+		op_unregister_emitter,
+		op_set_number_of_listeners,
+		op_set_listener_weight,
+		op_set_bus_volume,
+		op_set_vca_volume,
+		op_activate_snapshot,
+		op_set_snapshot_intensity,
+		op_release_snapshot,
+		op_reload_bank,
+		op_set_voiceover_locale,
+		op_set_lazy_bank_loading,
+		op_load_bank_manifest,
+		op_set_update_coalescing,
+		op_enable_occlusion,
+		op_disable_occlusion,
+		op_set_occlusion_settings,
+		op_add_streaming_zone,
+		op_remove_streaming_zone,
+		op_add_bus_meter,
+		op_remove_meter,
+		op_set_meter_smoothing,
+		op_set_emitter_lod_settings,
+		op_restore_audio_state,
+		op_register_emitter_weighted,
+		op_enable_emitter_clustering,
+		op_disable_emitter_clustering,
+		op_set_emitter_lod_settings_interpolated,
+		op_schedule_play_after_event,
+		op_schedule_play_on_beat
+	};
+
+	static const unsigned int file_magic = 0x4C435746; // "FWCL"
+	static const unsigned int file_version = 1;
+
+	CallRecorder();
+	~CallRecorder();
+
+	int open(const std::string& file_path);
+	void close();
+	unsigned long int getFrame() const { return m_frame; }
+
+	void recordUpdate();
+	void recordBankOp(CaptureOp op, const std::string& bank, bool load_samples = false);
+	void recordReloadBank(const std::string& bank, float drain_timeout);
+	void recordSetVoiceoverLocale(const std::string& locale, const std::string& bank);
+	void recordSetLazyBankLoading(bool enabled, float timeout_seconds);
+	void recordPlay3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id);
+	void recordPlay2D(const std::string& event, const std::map<std::string, float>& parameters, unsigned long int id);
+	void recordPlayOneShot3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters);
+	void recordPlayOneShot2D(const std::string& event, const std::map<std::string, float>& parameters);
+	void recordSchedulePlayAfterEvent(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id);
+	void recordSchedulePlayOnBeat(const std::string& event, int reference_event_id, bool on_bar, int extra, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id);
+	void recordStop(int event_id, bool allow_fades);
+	void recordSet3DAttributes(int event_id, const FMOD_3D_ATTRIBUTES& spatial_attributes);
+	void recordEmitterOp(CaptureOp op, int event_id);
+	void recordRegisterEmitter(int event_id, float cluster_weight);
+	void recordEnableEmitterClustering(const std::string& event, const EmitterClusterSettings& settings);
+	void recordDisableEmitterClustering(const std::string& event);
+	void recordSetEmitterLodSettings(const EmitterLodSettings& settings);
+	void recordEnableOcclusion(int event_id, const std::string& parameter);
+	void recordSetOcclusionSettings(const OcclusionSettings& settings);
+	void recordAddStreamingZone(const StreamingZone& zone, unsigned long int id);
+	void recordAddBusMeter(const std::string& bus, unsigned long int id);
+	void recordSetMeterSmoothing(float attack_seconds, float release_seconds);
+	// The (saved ID, new ID) pairs let the replay remap the restored instances like any other play.
+	void recordRestoreAudioState(const std::vector<unsigned char>& blob, int instances_per_update, bool stop_current, float bank_timeout, const std::vector<std::pair<unsigned long int, unsigned long int>>& id_map);
+
+	// Calls taking nothing but an ID, e.g. "removeMeter".
+	void recordIdOp(CaptureOp op, unsigned long int id);
+	void recordSetListenerAttributes(int listener_index, const FMOD_3D_ATTRIBUTES& spatial_attributes);
+	void recordSetNumberOfListeners(int num_listeners);
+	void recordSetListenerWeight(int listener_index, float weight);
+	void recordSetParameter(int event_id, const std::string& parameter, float value);
+	void recordSetGlobalParameter(const std::string& parameter, float value);
+	void recordSetUpdateCoalescing(bool enabled, float parameter_epsilon, float movement_threshold);
+	void recordBusOp(CaptureOp op, const std::string& bus, bool flag);
+	void recordMixerVolume(CaptureOp op, const std::string& path, float volume, float fade_seconds);
+	void recordActivateSnapshot(const std::string& snapshot, float intensity, int priority, float ramp_seconds, unsigned long int id);
+	void recordSnapshotIntensity(unsigned long int request_id, float intensity, float ramp_seconds);
+	void recordReleaseSnapshot(unsigned long int request_id, float ramp_seconds);
+	void recordPlayDialogue3D(const std::string& key, int master_event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int id);
+	void recordPlayDialogue2D(const std::string& key, int master_event, const std::map<std::string, float>& parameters, unsigned long int id);
+
+private:
+
+	std::ofstream m_file;
+	std::vector<unsigned char> m_buffer;
+	std::unordered_map<std::string, unsigned long int> m_strings;
+	unsigned long int m_frame;
+	std::chrono::steady_clock::time_point m_start_time;
+
+	void writeByte(unsigned char value);
+	void writeVarint(unsigned long long value);
+	void writeFloat(float value);
+	void writeVector(const FMOD_VECTOR& vector);
+	void writeAttributes(const FMOD_3D_ATTRIBUTES& attributes);
+	void writeParameters(const std::map<std::string, float>& parameters);
+	void writeStringRef(const std::string& value);
+
+	// String definitions have to precede the record that refers to them, so intern all strings of a call before writing its opcode.
+	void internString(const std::string& value);
+	void internParameters(const std::map<std::string, float>& parameters);
+	void flushBuffer();
+};
+
+struct ReplayStats
+{
+	unsigned long int frames = 0;
+	unsigned long int calls = 0;
+	double total_update_ms = 0.0;
+	double worst_update_ms = 0.0;
+	unsigned long int worst_update_frame = 0;
+};
+
+// Feeds a capture log back through the wrapper. Event IDs from the capture are remapped to the IDs handed out during the replay.
+
+class CallReplayer
+{
+public:
+
+	enum ReplayMode
+	{
+		full_speed,
+		real_time
+	};
+
+	int replay(const std::string& file_path, FmodWrapper& wrapper, ReplayMode mode, ReplayStats* stats = nullptr);
+
+private:
+
+	std::vector<unsigned char> m_data;
+	size_t m_position = 0;
+	bool m_read_error = false;
+	std::vector<std::string> m_strings;
+	std::unordered_map<unsigned long int, unsigned long int> m_id_map;
+
+	unsigned char readByte();
+	unsigned long long readVarint();
+	float readFloat();
+	FMOD_VECTOR readVector();
+	FMOD_3D_ATTRIBUTES readAttributes();
+	std::map<std::string, float> readParameters();
+	const std::string& readStringRef();
+	int mapId(unsigned long long recorded_id);
+	void addIdMapping(unsigned long long recorded_id, unsigned long int id);
+};
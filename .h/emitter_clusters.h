@@ -0,0 +1,125 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "fmod_studio.hpp"
+
+struct EmitterClusterSettings
+{
+	// An emitter joins the closest cluster whose centre is within "join_radius", otherwise it starts a new cluster.
+	float join_radius = 6.0f;
+
+	// A clustered emitter only leaves its cluster once it is further than "leave_radius" from the centre,
+	// so that emitters on the border don't flip between clusters every update.
+	float leave_radius = 9.0f;
+
+	// Clusters whose centres have come closer than this are merged.
+	float merge_distance = 3.0f;
+
+	// Set on each cluster's instance to the number of emitters in the cluster. Empty for none.
+	std::string density_parameter = "Density";
+
+	// Centre moves shorter than this are not sent to FMOD.
+	float movement_threshold = 0.05f;
+};
+
+struct EmitterClusterStats
+{
+	unsigned long int emitters = 0;
+	unsigned long int clusters = 0;
+	// Clusters started for emitters that left their cluster, and clusters absorbed by a nearby one.
+	unsigned long long splits = 0;
+	unsigned long long merges = 0;
+	unsigned long int attribute_writes_last_update = 0;
+	unsigned long int parameter_writes_last_update = 0;
+};
+
+// Plays many emitters of the same event as one instance per spatial cluster. The instance sits at the weighted centre of its emitters
+// and gets their count as a "density" parameter, so that e.g. a crowd of forty costs a handful of instances and API calls per update.
+
+class EmitterClusters
+{
+public:
+
+	EmitterClusters();
+	~EmitterClusters();
+
+	// Groups are kept by "event" (path or GUID), so that they can find the event again after its bank has been unloaded or reloaded.
+	int enable(const std::string& event, FMOD::Studio::EventDescription* description, const EmitterClusterSettings& settings);
+	// Stops the event's cluster instances and drops its emitters.
+	int disable(const std::string& event);
+	bool isEnabled(FMOD::Studio::EventDescription* description) const { return findGroup(description) != nullptr; }
+
+	// "weight" pulls the cluster centre towards the emitter, e.g. for louder members.
+	int add(unsigned long int id, FMOD::Studio::EventDescription* description, const FMOD_VECTOR& position, float weight = 1.0f);
+	int remove(unsigned long int id);
+	bool contains(unsigned long int id) const { return m_emitter_group.find(id) != m_emitter_group.end(); }
+	int setPosition(unsigned long int id, const FMOD_VECTOR& position);
+
+	// A group whose description has turned invalid loses its cluster instances and looks the event up again from "system".
+	// Its emitters are kept and clustered again once the event is back.
+	void update(FMOD::Studio::System* system);
+
+	EmitterClusterStats getStats() const;
+
+private:
+
+	struct Emitter
+	{
+		unsigned long int id;
+		FMOD_VECTOR position;
+		float weight;
+		int cluster;
+	};
+
+	struct Cluster
+	{
+		FMOD::Studio::EventInstance* instance;
+		FMOD_VECTOR centre;
+		FMOD_VECTOR sent_centre;
+		float total_weight;
+		int members;
+		int sent_members;
+		bool merged;
+	};
+
+	struct Group
+	{
+		std::string event;
+		// Null while the event's bank isn't loaded.
+		FMOD::Studio::EventDescription* description;
+		EmitterClusterSettings settings;
+		bool has_density;
+		FMOD_STUDIO_PARAMETER_ID density_id;
+
+		// Removal swaps the last emitter / cluster into the freed slot.
+		std::vector<Emitter> emitters;
+		std::unordered_map<unsigned long int, size_t> index;
+		std::vector<Cluster> clusters;
+	};
+
+	std::vector<Group*> m_groups;
+	std::unordered_map<std::string, size_t> m_group_index;
+	std::unordered_map<unsigned long int, Group*> m_emitter_group;
+
+	unsigned long long m_splits;
+	unsigned long long m_merges;
+	unsigned long int m_attribute_writes;
+	unsigned long int m_parameter_writes;
+
+	Group* findGroup(FMOD::Studio::EventDescription* description) const;
+	void resolveDescription(Group& group, FMOD::Studio::EventDescription* description);
+	void dropClusters(Group& group);
+	void updateGroup(Group& group);
+	void recomputeCentres(Group& group);
+	int createCluster(Group& group, const FMOD_VECTOR& position);
+	void mergeClusters(Group& group);
+	void removeEmptyClusters(Group& group);
+	void apply(Group& group);
+	void stopCluster(Cluster& cluster);
+};
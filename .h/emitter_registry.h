@@ -0,0 +1,100 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "fmod_studio.hpp"
+
+struct EmitterLodSettings
+{
+	// Edge length of the uniform grid cells the emitters are binned into. Should be in the same range as "near_distance".
+	float cell_size = 32.0f;
+
+	// Emitters closer than this to any listener are updated every tick.
+	float near_distance = 32.0f;
+
+	// Emitters between "near_distance" and "mid_distance" are updated every "mid_interval" ticks, anything further every "far_interval" ticks.
+	float mid_distance = 96.0f;
+	int mid_interval = 4;
+	int far_interval = 15;
+
+	// Position, orientation and velocity changes smaller than this are not sent to FMOD at all.
+	float movement_threshold = 0.01f;
+
+	// Emitters on a reduced rate glide from their last sent position to the new one over their interval instead of jumping.
+	// A gliding emitter is sent once per tick until it arrives, so this only costs calls for the distant emitters that actually move.
+	bool interpolate = true;
+};
+
+struct EmitterStats
+{
+	unsigned long int emitters = 0;
+	unsigned long int sent_last_update = 0;
+	unsigned long int skipped_last_update = 0;
+	unsigned long long sent_total = 0;
+	unsigned long long skipped_total = 0;
+};
+
+// Holds the latest 3D attributes of registered event instances and decides how often they are pushed to FMOD, based on the distance to the closest listener.
+// Emitters are binned into a uniform grid, so that the ones near a listener can be found without going through the whole registry.
+
+class EmitterRegistry
+{
+public:
+
+	EmitterRegistry();
+
+	int add(unsigned long int id, FMOD::Studio::EventInstance* instance);
+	int remove(unsigned long int id);
+	bool contains(unsigned long int id) const { return m_index.find(id) != m_index.end(); }
+
+	// Stores the attributes, they are sent to FMOD during the next "update" when the emitter is due.
+	int setAttributes(unsigned long int id, const FMOD_3D_ATTRIBUTES& attributes);
+
+	void update(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners, float delta_time);
+
+	void setSettings(const EmitterLodSettings& settings);
+	const EmitterStats& getStats() const { return m_stats; }
+
+private:
+
+	struct Emitter
+	{
+		unsigned long int id;
+		FMOD::Studio::EventInstance* instance;
+		FMOD_3D_ATTRIBUTES target;
+		FMOD_3D_ATTRIBUTES sent;
+		long long cell;
+		unsigned long int next_update_tick;
+		float time_since_sent;
+		bool dirty;
+
+		// Position the current glide started from. The glide heads for the latest target, so it follows a moving emitter.
+		FMOD_VECTOR glide_from;
+		int glide_step;
+		int glide_steps;
+	};
+
+	EmitterLodSettings m_settings;
+	EmitterStats m_stats;
+	unsigned long int m_tick;
+
+	// Densely packed so that the per-tick scan stays cache friendly. Removal swaps the last emitter into the freed slot.
+	std::vector<Emitter> m_emitters;
+	std::unordered_map<unsigned long int, size_t> m_index;
+	std::unordered_map<long long, std::vector<unsigned long int>> m_cells;
+
+	long long cellKey(int x, int y, int z) const;
+	long long cellOf(const FMOD_VECTOR& position) const;
+	void insertIntoCell(long long cell, unsigned long int id);
+	void removeFromCell(long long cell, unsigned long int id);
+	void rebuildCells();
+
+	float closestListenerDistanceSq(const FMOD_VECTOR& position, const FMOD_3D_ATTRIBUTES* listeners, int num_listeners) const;
+	bool moved(const FMOD_3D_ATTRIBUTES& target, const FMOD_3D_ATTRIBUTES& sent, float threshold_sq) const;
+	void glide(Emitter& emitter);
+	void send(Emitter& emitter, const FMOD_3D_ATTRIBUTES& attributes);
+};
@@ -1,103 +1,989 @@
-MIT License
-Copyright (c) 2020 Ville Ojala
-
-#pragma once
-
-#include <iostream>
-#include <string>
-#include <vector>
-#include <map>
-#include "fmod.hpp"
-#include "fmod_studio.hpp"
-#include "id_system.h"
-
-struct DialogueUserData
-{
-	bool is_3d;
-	std::string line_key;
-	unsigned long int associated_event_id;
-};
-
-class WrapperImplementation
-{
-private:
-
-	WrapperImplementation();
-	~WrapperImplementation();
-
-	void runUpdate();
-
-	FMOD::Studio::System* studio_system;
-	FMOD::System* core_system;
-
-	// Each event instance will be assigned with a unique id for later access (e.g. to update positional and parameter data)
-	std::map<unsigned long int, FMOD::Studio::EventInstance*> m_events;
-
-	std::map<std::string, FMOD::Studio::Bank*> m_banks;
-	std::map<unsigned long int, DialogueUserData*> m_alloc_dialogue_user_data;
-
-public:
-
-	friend class FmodWrapper;
-};
-
-class FmodWrapper
-{
-private:
-
-	static void initializeIdSystem();
-	static int setNumberOfListeners(int num_listeners);	
-	static bool audio_engine_initialized;
-	
-	// To be used as a default argument for all "play sound" -functions when the caller does not provide any fmod parameters to set.  
-	static std::map<std::string, float> empty_map;
-
-public:
-
-	// Passing arguments by value vs. reference should be re-evaluated based on the call system implementation on the game engine side. 
-
-	static void initializeAudioEngine();
-	static void callUpdate();
-	static void shutDownAudioEngine();
-	static int errorCheck(FMOD_RESULT result);
-
-	int loadBank(const std::string& bank, bool load_samples = true);
-	int unloadBank(const std::string& bank);
-	int loadSampleData(const std::string& bank);
-	int unloadSampleData(const std::string& bank);
-
-	unsigned long int play3DEvent(const std::string& event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters = empty_map);
-	unsigned long int play2DEvent(const std::string& event, std::map<std::string, float> parameters = empty_map);
-	int stopEvent(int event_id, bool allow_fades = true);
-	
-	int set3DAttributes(int event_id, FMOD_3D_ATTRIBUTES spatial_attributes);
-	static int setListenerAttributes(int listener_index, FMOD_3D_ATTRIBUTES spatial_attributes); 
-	
-	int setParameterByName(int event_id, std::string& parameter, float value);
-	int setGlobalParameterByName(std::string& parameter, float value);
-
-	// These are commonly needed when implementing main and pause menu systems.
-	int setBusPauseStatus(const std::string& bus, bool is_paused);
-	int stopAllBusEvents(const std::string& bus, bool allow_fades);
-	
-
-	// Programmer sound / audio table system for voiceovers -->
-
-	// Create an enum value for each programmer sound instrument you want to use in FMOD Studio for dialogue mixer routing and other speaker/situation specific processing.
-	enum DialogueMasterEvents
-	{
-		//For example...
-
-		PC,
-		NPC,
-		NPC_radio
-
-		//...etc.....	
-	};
-	
-	static FMOD_RESULT F_CALLBACK dialogueEventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void* parameter);
-
-	unsigned long int playDialogue3D(const std::string key, DialogueMasterEvents master_event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters = empty_map);
-	unsigned long int playDialogue2D(const std::string key, DialogueMasterEvents master_event, std::map<std::string, float> parameters = empty_map);
-
-};
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <unordered_set>
+#include "fmod.hpp"
+#include "fmod_studio.hpp"
+#include "id_system.h"
+#include "spsc_ring.h"
+#include "emitter_registry.h"
+#include "emitter_clusters.h"
+#include "level_meters.h"
+#include "occlusion.h"
+#include "bank_manifest.h"
+#include "audio_state.h"
+
+// How dialogue lines from the audio table are opened. Long lines are streamed from disk, short ones are loaded as compressed samples.
+struct DialogueSoundSettings
+{
+	// A line is streamed if its size in the bank is at least "stream_min_bytes", or if its estimated length is at least "stream_min_seconds".
+	// The length is estimated from the size and "encoded_bytes_per_second" of the project's voice encoding (e.g. Vorbis at quality ~ 8 KB/s).
+	unsigned int stream_min_bytes = 256 * 1024;
+	float stream_min_seconds = 10.0f;
+	float encoded_bytes_per_second = 8192.0f;
+
+	// Streams open at the same time. Lines over the limit are loaded as compressed samples instead.
+	int max_streams = 8;
+
+	// File and decode buffer sizes of each stream, so that the memory of the stream pool stays fixed at "max_streams" times their sum.
+	// The file buffer size is a core system setting (System::setStreamBufferSize) and applies to every stream the system opens,
+	// including streamed assets of the banks. The default matches FMOD's own default, so only a changed value affects them.
+	// The decode buffer is converted to PCM samples at the output rate and only applies to the dialogue streams.
+	unsigned int stream_file_buffer_bytes = 16 * 1024;
+	unsigned int stream_decode_buffer_ms = 400;
+};
+
+struct DialogueSoundStats
+{
+	int open_streams = 0;
+	int peak_open_streams = 0;
+	int max_streams = 0;
+	unsigned long long streams_opened = 0;
+	unsigned long long samples_created = 0;
+	// Lines that should have been streamed but found the stream pool full.
+	unsigned long long stream_pool_fallbacks = 0;
+	// Memory held by the compressed samples of playing lines.
+	unsigned long long sample_bytes = 0;
+	unsigned long long peak_sample_bytes = 0;
+};
+
+struct StartupBank
+{
+	std::string file;
+	bool load_samples = false;
+};
+
+// Engine-wide settings applied when the audio engine is created.
+struct AudioEngineSettings
+{
+	// Non-realtime output mixes as fast as "update" is called and outputs nothing. Used for offline replay of capture logs.
+	bool non_realtime_output = false;
+
+	// Number of listeners to set up, e.g. one per split screen player. Can be changed later with "setNumberOfListeners".
+	int num_listeners = 1;
+
+	// Master bank and the master string bank. Add project specific locations here.
+	std::string master_bank = "D:/FmodTestProject/Build/Desktop/Master.bank";
+	std::string master_strings_bank = "D:/FmodTestProject/Build/Desktop/Master.strings.bank";
+
+	// Further banks to load during initialization (see "FmodWrapper::loadStartupManifest"). All loads, the master banks' included, are issued at once in non-blocking mode.
+	std::vector<StartupBank> startup_banks;
+
+	// Block in "initializeAudioEngine" until every startup bank has loaded. Otherwise they finish during the following updates.
+	// Banks still loading after "startup_wait_timeout" seconds are reported as failed and initialization carries on.
+	bool wait_for_startup_banks = true;
+	float startup_wait_timeout = 10.0f;
+
+	// Read the bank files on background threads while the FMOD system is being created, and load them from memory.
+	// Trades memory for boot time: a bank loaded from memory keeps its whole file resident, streamed assets included.
+	// Leave voiceover locale banks to "setVoiceoverLocale": lines opened from a bank in memory would not survive its unload on a locale switch.
+	bool preread_bank_files = false;
+
+	DialogueSoundSettings dialogue_sounds;
+};
+
+struct StartupBankTiming
+{
+	std::string file;
+	bool load_samples = false;
+	bool failed = false;
+
+	// From issuing the load until the metadata / sample data had loaded.
+	double metadata_ms = 0.0;
+	double sample_data_ms = 0.0;
+};
+
+struct StartupTimingReport
+{
+	double create_ms = 0.0;
+	double initialize_ms = 0.0;
+
+	// Issuing the non-blocking loads, including waiting for pre-read files.
+	double issue_loads_ms = 0.0;
+	double first_update_ms = 0.0;
+
+	// Time blocked in "initializeAudioEngine" waiting for the startup banks.
+	double wait_ms = 0.0;
+
+	// From the start of initialization until the last startup bank had loaded. Valid once "complete" is set.
+	double total_ms = 0.0;
+	bool complete = false;
+	// The wait gave up on the banks still loading. They may still finish during the following updates.
+	bool timed_out = false;
+
+	std::vector<StartupBankTiming> banks;
+};
+
+// Sizes of the wrapper's internal containers, for leak hunting in long running sessions (see soak_test.cpp).
+// With nothing playing, every count except "banks", "event_descriptions" and "meters" should return to zero.
+struct WrapperDiagnostics
+{
+	unsigned long int events = 0;
+	unsigned long int dialogue_user_data = 0;
+	unsigned long int event_callback_data = 0;
+	unsigned long int deferred_plays = 0;
+	unsigned long int staged_writes = 0;
+	unsigned long int dirty_events = 0;
+	unsigned long int mixer_fades = 0;
+	unsigned long int snapshots = 0;
+	unsigned long int snapshot_requests = 0;
+	unsigned long int emitters = 0;
+	unsigned long int meters = 0;
+	unsigned long int occlusion_emitters = 0;
+	unsigned long int banks = 0;
+	unsigned long int pending_bank_loads = 0;
+	unsigned long int bank_reloads = 0;
+	unsigned long int event_descriptions = 0;
+	unsigned long int scheduled_plays = 0;
+	unsigned long int clustered_emitters = 0;
+	// Destroyed instances whose user data didn't fit into the release ring, freed by a sweep instead.
+	unsigned long int released_user_data_overflows = 0;
+};
+
+// Structure-of-arrays listener transforms for "setListenerAttributesBatch". Each pointer refers to an array with one value per listener.
+// The velocity arrays can be left null, in which case the listeners are treated as stationary. A null position, forward or up array fails the call.
+struct ListenerTransformsSoA
+{
+	const float* position_x = nullptr;
+	const float* position_y = nullptr;
+	const float* position_z = nullptr;
+	const float* forward_x = nullptr;
+	const float* forward_y = nullptr;
+	const float* forward_z = nullptr;
+	const float* up_x = nullptr;
+	const float* up_y = nullptr;
+	const float* up_z = nullptr;
+	const float* velocity_x = nullptr;
+	const float* velocity_y = nullptr;
+	const float* velocity_z = nullptr;
+};
+
+// Counters for the per-frame coalescing of "set3DAttributes" and "setParameterByName" writes.
+struct CoalescingStats
+{
+	// Writes received from the game.
+	unsigned long long staged = 0;
+	// Writes overwritten by a later write to the same event before the update.
+	unsigned long long coalesced = 0;
+	// Writes dropped during the update because the change was below the epsilon / movement threshold.
+	unsigned long long skipped = 0;
+	// Writes actually sent to FMOD.
+	unsigned long long flushed = 0;
+	unsigned long int flushed_last_update = 0;
+	// Flushed writes that FMOD rejected, e.g. for an instance released during the frame. The game already got 1 for these.
+	unsigned long long failed = 0;
+};
+
+struct StagedParameter
+{
+	std::string name;
+	// Resolved when the write is staged, so that unknown parameters are rejected right away.
+	FMOD_STUDIO_PARAMETER_ID id;
+	float pending_value = 0.0f;
+	float sent_value = 0.0f;
+	bool has_pending = false;
+	bool has_sent = false;
+};
+
+// The latest not yet flushed writes for one event instance, and the last values sent to FMOD for the epsilon checks.
+struct StagedEventWrites
+{
+	FMOD::Studio::EventInstance* instance = nullptr;
+	FMOD_3D_ATTRIBUTES pending_attributes;
+	FMOD_3D_ATTRIBUTES sent_attributes;
+	bool has_pending_attributes = false;
+	bool has_sent_attributes = false;
+	bool queued = false;
+	std::vector<StagedParameter> parameters;
+};
+
+// A volume ramp on a bus or a VCA, advanced by the wrapper update.
+struct MixerFade
+{
+	FMOD::Studio::Bus* bus = nullptr;
+	FMOD::Studio::VCA* vca = nullptr;
+	float start_volume = 1.0f;
+	float target_volume = 1.0f;
+	float duration = 0.0f;
+	float elapsed = 0.0f;
+};
+
+struct SnapshotRequest
+{
+	unsigned long int id;
+	int priority;
+	float intensity;
+};
+
+// One snapshot instance shared by every request for that snapshot. The intensity follows the highest priority request (the latest one on ties).
+struct ActiveSnapshot
+{
+	FMOD::Studio::EventInstance* instance = nullptr;
+	std::vector<SnapshotRequest> requests;
+	int priority = 0;
+	float current_intensity = 0.0f;
+	float target_intensity = 0.0f;
+	float ramp_rate = 0.0f;
+	bool intensity_dirty = false;
+	bool releasing = false;
+};
+
+// A play request waiting for the bank of its event to finish loading.
+struct DeferredPlay
+{
+	std::string event;
+	std::string bank;
+	bool is_3d = false;
+	FMOD_3D_ATTRIBUTES attributes;
+	std::map<std::string, float> parameters;
+	float waited = 0.0f;
+	// Queued behind a hot reload rather than a lazy bank load.
+	bool reload_swap = false;
+
+	// Plays queued by "restoreAudioState": "event" holds the GUID, and the saved state is applied before starting.
+	bool restored = false;
+	int timeline_position = 0;
+	bool paused = false;
+	bool register_emitter = false;
+	std::vector<SavedParameter> parameter_values;
+	// How long a restored play may wait for its bank, independent of the lazy loading timeout.
+	float restore_timeout = 0.0f;
+};
+
+struct AudioStateStats
+{
+	unsigned long int captured_instances = 0;
+	unsigned long int restored_instances = 0;
+	unsigned long int failed_instances = 0;
+	// Restored plays still waiting for their turn or their bank.
+	unsigned long int pending_instances = 0;
+};
+
+struct LazyLoadStats
+{
+	// Plays that had to wait for their bank, and bank loads started because of them.
+	unsigned long int deferred_plays = 0;
+	unsigned long int on_demand_bank_loads = 0;
+	unsigned long int served = 0;
+	unsigned long int timeouts = 0;
+	unsigned long int failed = 0;
+	double total_latency_ms = 0.0;
+	double max_latency_ms = 0.0;
+};
+
+// File contents of a bank read by a background thread, for hot reloads and pre-read startup banks.
+struct BankFileRead
+{
+	enum Status
+	{
+		read_pending,
+		read_done,
+		read_failed
+	};
+
+	std::vector<char> data;
+	std::atomic<int> status = { read_pending };
+};
+
+struct BankReload
+{
+	enum Phase
+	{
+		// The new version is read from disk, the old one keeps playing as usual.
+		reading,
+		// New plays of the bank are deferred until the one-shot instances of the old version have ended (or "drain_timeout" has passed).
+		draining,
+		// The old version has been unloaded and the new one is loading from memory.
+		loading
+	};
+
+	Phase phase = reading;
+	std::shared_ptr<BankFileRead> read;
+	float drain_timeout = 0.5f;
+	float elapsed = 0.0f;
+	bool reload_samples = false;
+	std::chrono::steady_clock::time_point start_time;
+};
+
+struct BankReloadStats
+{
+	unsigned long int started = 0;
+	unsigned long int completed = 0;
+	unsigned long int failed = 0;
+	// Reloads whose old one-shot instances were still playing at the drain timeout. The unload stopped them.
+	unsigned long int drain_timeouts = 0;
+	// Plays that waited for a bank swap, and how long they waited before starting on the new version.
+	unsigned long int deferred_plays = 0;
+	unsigned long int deferred_plays_failed = 0;
+	double total_deferred_ms = 0.0;
+	double max_deferred_ms = 0.0;
+	double total_reload_ms = 0.0;
+	double max_reload_ms = 0.0;
+};
+
+// The voiceover audio table bank being loaded for a locale switch.
+struct VoiceoverLocaleSwitch
+{
+	std::string locale;
+	std::string bank;
+	FMOD::Studio::Bank* bank_handle = nullptr;
+	std::chrono::steady_clock::time_point start_time;
+};
+
+struct VoiceoverLocaleStats
+{
+	std::string locale;
+	// Locale whose bank is being loaded, empty when no switch is in progress.
+	std::string pending_locale;
+	unsigned long int switches = 0;
+	unsigned long int failed_switches = 0;
+
+	// From "setVoiceoverLocale" until new lines resolved against the new bank.
+	double last_switch_ms = 0.0;
+	double max_switch_ms = 0.0;
+
+	// FMOD memory when the last switch was requested, and the highest seen until the lines of the previous locale had finished.
+	int memory_before_switch = 0;
+	int peak_switch_memory = 0;
+
+	// Lines still playing in earlier locales, and how long the lines of the last previous locale took to finish after the switch.
+	int previous_locale_lines = 0;
+	double last_drain_ms = 0.0;
+};
+
+// A play waiting in the DSP clock schedule.
+struct ScheduledPlay
+{
+	std::string event;
+	bool is_3d = false;
+	FMOD_3D_ATTRIBUTES attributes;
+	std::map<std::string, float> parameters;
+
+	// Start time in master DSP clock samples. 0 while a beat aligned play waits for its reference's beat.
+	unsigned long long dsp_clock = 0;
+
+	// Beat aligned plays.
+	unsigned long int reference_id = 0;
+	bool on_bar = false;
+	int extra = 0;
+};
+
+// Last timeline beat of an event used as a schedule reference.
+struct ReferenceBeat
+{
+	unsigned long long dsp_clock = 0;
+	float tempo = 0.0f;
+	int beat = 0;
+	int time_signature_upper = 0;
+};
+
+struct ScheduleStats
+{
+	unsigned long int scheduled = 0;
+	unsigned long int started = 0;
+	unsigned long int failed = 0;
+	// Plays still waiting in the schedule.
+	unsigned long int pending = 0;
+
+	// Plays whose time had already passed when they were issued, e.g. scheduled closer than the lookahead or after a long frame.
+	// They start as soon as possible, and the error is how much later than requested.
+	unsigned long int late = 0;
+	double total_error_ms = 0.0;
+	double max_error_ms = 0.0;
+
+	// How far ahead of their time the plays were issued.
+	double min_lead_ms = 0.0;
+	double total_lead_ms = 0.0;
+};
+
+// A region of the world tied to a set of banks whose sample data should be resident while a listener is nearby.
+struct StreamingZone
+{
+	// Sphere (center + radius) or axis-aligned box (center + half extents).
+	bool is_sphere = true;
+	FMOD_VECTOR center = { 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+	FMOD_VECTOR half_extents = { 0.0f, 0.0f, 0.0f };
+
+	// Loading starts when a listener comes within "prefetch_distance" of the zone, and the sample data is released once
+	// every listener is further than "release_distance". Keep the release distance larger, so that walking along the edge doesn't thrash.
+	float prefetch_distance = 50.0f;
+	float release_distance = 75.0f;
+
+	std::vector<std::string> banks;
+};
+
+struct StreamingZoneStats
+{
+	unsigned long int prefetches = 0;
+	unsigned long int releases = 0;
+	// A listener entered a zone before its sample data had finished loading.
+	unsigned long int late_loads = 0;
+	// Time between the sample data becoming resident and a listener entering the zone.
+	unsigned long int lead_time_samples = 0;
+	double total_lead_time_ms = 0.0;
+	double min_lead_time_ms = 0.0;
+};
+
+struct StreamingZoneState
+{
+	StreamingZone zone;
+	bool prefetched = false;
+	bool resident = false;
+	bool entered = false;
+	std::chrono::steady_clock::time_point resident_time;
+};
+
+// An event callback copied out of FMOD's thread. Only the fields relevant to "type" are filled in.
+struct EventCallbackMessage
+{
+	unsigned long int event_id = 0;
+	FMOD_STUDIO_EVENT_CALLBACK_TYPE type = 0;
+
+	// Master channel group DSP clock (in output samples) sampled by the wrapper update that preceded the callback,
+	// so it can be up to an update behind. For beats, the timeline "position" is exact.
+	unsigned long long dsp_clock = 0;
+
+	// Timeline position in milliseconds, for markers and beats.
+	int position = 0;
+
+	// Beats only.
+	int bar = 0;
+	int beat = 0;
+	float tempo = 0.0f;
+	int time_signature_upper = 0;
+	int time_signature_lower = 0;
+
+	// Markers only. Longer names are truncated.
+	char marker_name[64] = {};
+};
+
+typedef void (*EventCallbackHandler)(const EventCallbackMessage& message, void* user_data);
+
+struct CallbackSubscriber
+{
+	CallbackSubscriber(EventCallbackHandler handler, void* user_data, size_t capacity) : ring(capacity), handler(handler), user_data(user_data), dropped(0), active(true) {}
+
+	SpscRing<EventCallbackMessage> ring;
+	EventCallbackHandler handler;
+	void* user_data;
+
+	// Messages that didn't fit into the ring between two updates.
+	std::atomic<unsigned long int> dropped;
+	std::atomic<bool> active;
+};
+
+// Subscriptions of one event instance, read by FMOD's thread. The game thread only ever fills a free slot and then publishes it by
+// incrementing "count", so the callback can walk the slots without locking.
+struct EventCallbackData
+{
+	static const int max_subscribers = 4;
+
+	unsigned long int event_id = 0;
+	// Game thread only. Set once the callbacks are attached, lets the overflow sweep find destroyed instances.
+	FMOD::Studio::EventInstance* instance = nullptr;
+	CallbackSubscriber* subscribers[max_subscribers] = {};
+	std::atomic<unsigned int> types[max_subscribers] = {};
+	std::atomic<int> count = { 0 };
+};
+
+// Instance user data handed back from the DESTROYED callback, so that it is freed on the game thread.
+struct ReleasedUserData
+{
+	unsigned long int event_id = 0;
+	void* data = nullptr;
+	bool is_dialogue = false;
+};
+
+struct DialogueUserData
+{
+	bool is_3d;
+	std::string line_key;
+	unsigned long int associated_event_id;
+	EventCallbackData callbacks;
+
+	// How the programmer sound was opened, for releasing its stream slot or sample memory.
+	bool streamed = false;
+	unsigned int sample_bytes = 0;
+
+	// Voiceover locale generation the line was resolved in, -1 until its programmer sound has been created.
+	// Selects the counter in "m_voiceover_lines" the line is counted against.
+	int locale_generation = -1;
+};
+
+class WrapperImplementation
+{
+private:
+
+	WrapperImplementation(const AudioEngineSettings& settings);
+	~WrapperImplementation();
+
+	void runUpdate();
+
+	// Erases the bookkeeping of an event instance that has stopped or turned invalid.
+	void eraseEvent(std::map<unsigned long int, FMOD::Studio::EventInstance*>::iterator& it);
+
+	// Sends the last staged attribute and parameter values of each written event to FMOD.
+	void flushStagedWrites();
+	bool resolveParameterId(FMOD::Studio::EventInstance* instance, const std::string& parameter, FMOD_STUDIO_PARAMETER_ID& id);
+
+	// Bus and VCA handles are resolved once and cached by path. "cacheMixerHandles" prefetches the handles of a freshly loaded bank.
+	FMOD::Studio::Bus* getBus(const std::string& bus);
+	FMOD::Studio::VCA* getVCA(const std::string& vca);
+	void cacheMixerHandles(FMOD::Studio::Bank* bank);
+	void cancelMixerFade(FMOD::Studio::Bus* bus, FMOD::Studio::VCA* vca);
+	void startMixerFade(FMOD::Studio::Bus* bus, FMOD::Studio::VCA* vca, float start_volume, float target_volume, float fade_seconds);
+	void updateMixerFades();
+
+	// Advances snapshot intensity ramps and stops the snapshots whose last request has been released.
+	// Snapshots that died with their bank are restarted, or dropped along with their requests if the bank is gone.
+	void updateSnapshots();
+	void retargetSnapshot(ActiveSnapshot& snapshot, float ramp_seconds);
+	void sortActiveSnapshots();
+	int startSnapshotInstance(const std::string& snapshot, ActiveSnapshot& active);
+	void forgetSnapshotRequests(const ActiveSnapshot& snapshot);
+
+	// Starts a non-blocking bank load, or returns the bank if it is already loaded / loading.
+	FMOD::Studio::Bank* requestBankLoad(const std::string& bank);
+	void updatePendingBankLoads();
+
+	// Returns true if the event's bank is known from the manifest but not loaded yet. The play is then queued under "id" and started by the update.
+	// Also queues plays of a bank that is being swapped by "reloadBank".
+	bool deferUntilBankLoaded(const std::string& event, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters, unsigned long int& id);
+	void updateDeferredPlays();
+
+	// Fills in the startup report as the startup banks finish loading.
+	void updateStartupLoads();
+	// Marks the startup banks still loading as failed and completes the report.
+	void abandonStartupLoads();
+
+	// Advances hot reloads: reading -> draining -> swapping to the new version.
+	void updateBankReloads();
+
+	// Resolves beat aligned plays and issues the scheduled plays due within the lookahead.
+	void updateScheduledPlays();
+	bool resolveBeatPlay(ScheduledPlay& play, unsigned long long now);
+	unsigned long long referenceStartClock(unsigned long int reference_id);
+
+	// Finishes a voiceover locale switch once the new audio table bank has loaded, and tracks the lines of the previous locale.
+	void updateVoiceoverLocale();
+	void completeVoiceoverLocaleSwitch();
+	// One-shot instances still playing from the bank.
+	int bankInstanceCount(FMOD::Studio::Bank* bank);
+
+	// Checks the streaming zones against the listener positions and loads / releases their banks' sample data.
+	void updateStreamingZones();
+	void acquireZoneBanks(StreamingZoneState& state);
+	void releaseZoneBanks(StreamingZoneState& state);
+	bool zoneBanksResident(const StreamingZoneState& state);
+
+	// Returns a cached event description, fetching it from the studio system on first use or after its bank has been reloaded.
+	FMOD::Studio::EventDescription* getEventDescription(const std::string& event);
+
+	// Hands the queued callback messages to the subscribers and frees the user data of destroyed instances.
+	void dispatchEventCallbacks();
+	void freeReleasedUserData();
+	// Frees the user data of instances that are no longer valid. Only needed after the release ring has overflown.
+	unsigned long int sweepReleasedUserData();
+
+	// Sets the callback and user data of an instance according to its subscriptions. Has to be called before "start" to receive STARTED.
+	int attachEventCallbacks(unsigned long int id, FMOD::Studio::EventInstance* instance);
+	// Frees the subscriptions of a deferred play that was never started.
+	void discardEventCallbacks(unsigned long int id);
+
+	FMOD::Studio::System* studio_system;
+	FMOD::System* core_system;
+	FMOD::ChannelGroup* m_master_channel_group;
+	// Master DSP clock sampled by each update just before the studio update, read by the callbacks on FMOD's thread.
+	std::atomic<unsigned long long> m_mix_clock;
+
+	// Each event instance will be assigned with a unique id for later access (e.g. to update positional and parameter data)
+	std::map<unsigned long int, FMOD::Studio::EventInstance*> m_events;
+
+	std::map<std::string, FMOD::Studio::Bank*> m_banks;
+	// Banks loaded with "loadBankMemory" (pre-read startup banks and hot reloads).
+	std::unordered_set<std::string> m_memory_banks;
+	std::unordered_map<std::string, FMOD::Studio::EventDescription*> m_event_descriptions;
+	std::unordered_map<FMOD::Studio::EventDescription*, std::unordered_map<std::string, FMOD_STUDIO_PARAMETER_ID>> m_parameter_ids;
+	std::map<unsigned long int, DialogueUserData*> m_alloc_dialogue_user_data;
+
+	// Written from FMOD's thread by the dialogue callback. The open stream count doubles as the stream pool.
+	DialogueSoundSettings m_dialogue_sound_settings;
+	std::atomic<int> m_open_dialogue_streams;
+	std::atomic<int> m_peak_dialogue_streams;
+	std::atomic<unsigned long long> m_dialogue_streams_opened;
+	std::atomic<unsigned long long> m_dialogue_samples_created;
+	std::atomic<unsigned long long> m_dialogue_stream_fallbacks;
+	std::atomic<unsigned long long> m_dialogue_sample_bytes;
+	std::atomic<unsigned long long> m_peak_dialogue_sample_bytes;
+
+	bool acquireDialogueStream();
+
+	std::map<unsigned long int, CallbackSubscriber*> m_callback_subscribers;
+	std::unordered_map<unsigned long int, EventCallbackData*> m_event_callback_data;
+	SpscRing<ReleasedUserData> m_released_user_data;
+	// Failed pushes into the release ring: the total for the diagnostics, and the ones the sweep hasn't caught up with yet.
+	std::atomic<unsigned long int> m_released_user_data_overflows;
+	std::atomic<unsigned long int> m_unswept_user_data;
+
+	std::unordered_map<std::string, FMOD::Studio::Bus*> m_buses;
+	std::unordered_map<std::string, FMOD::Studio::VCA*> m_vcas;
+	std::vector<MixerFade> m_mixer_fades;
+
+	BankManifest m_manifest;
+	std::vector<std::string> m_pending_bank_loads;
+	std::map<unsigned long int, DeferredPlay> m_deferred_plays;
+	bool m_lazy_loading_enabled;
+	float m_lazy_loading_timeout;
+	LazyLoadStats m_lazy_load_stats;
+
+	// Restored plays started per update.
+	int m_restore_budget;
+	AudioStateStats m_audio_state_stats;
+
+	std::chrono::steady_clock::time_point m_startup_time;
+	std::vector<FMOD::Studio::Bank*> m_startup_loads;
+	std::vector<std::chrono::steady_clock::time_point> m_startup_issue_times;
+	StartupTimingReport m_startup_report;
+
+	std::map<std::string, BankReload> m_bank_reloads;
+	BankReloadStats m_bank_reload_stats;
+
+	// Scheduled plays by ID, and the sorted schedule of their start times. Cancelled plays are skipped when their time comes up.
+	std::map<unsigned long int, ScheduledPlay> m_scheduled_plays;
+	std::multimap<unsigned long long, unsigned long int> m_schedule;
+	std::unordered_map<unsigned long int, unsigned long long> m_scheduled_start_clocks;
+	std::unordered_map<unsigned long int, ReferenceBeat> m_reference_beats;
+	unsigned long int m_beat_subscriber;
+	int m_sample_rate;
+	float m_schedule_lookahead;
+	ScheduleStats m_schedule_stats;
+
+	// Audio table bank per locale. The generation is bumped by each completed switch and read by the dialogue callback on FMOD's thread,
+	// which counts the playing lines of each generation by its parity.
+	std::map<std::string, std::string> m_voiceover_locales;
+	std::string m_voiceover_bank;
+	VoiceoverLocaleSwitch m_voiceover_switch;
+	VoiceoverLocaleStats m_voiceover_stats;
+	std::atomic<int> m_voiceover_generation;
+	// Playing lines per locale generation, indexed by generation. Updated from FMOD's thread.
+	static const int max_voiceover_generations = 4;
+	std::atomic<int> m_voiceover_lines[max_voiceover_generations];
+	bool m_voiceover_draining;
+	std::chrono::steady_clock::time_point m_voiceover_switch_time;
+
+	std::map<unsigned long int, StreamingZoneState> m_streaming_zones;
+	std::unordered_map<std::string, int> m_zone_bank_refs;
+	std::vector<std::string> m_zone_sample_loads;
+	StreamingZoneStats m_streaming_zone_stats;
+
+	std::map<std::string, ActiveSnapshot> m_snapshots;
+	std::unordered_map<unsigned long int, std::string> m_snapshot_requests;
+	std::vector<std::string> m_active_snapshot_names;
+
+	std::unordered_map<unsigned long int, StagedEventWrites> m_staged_writes;
+	std::vector<unsigned long int> m_dirty_events;
+	bool m_coalescing_enabled;
+	float m_parameter_epsilon;
+	float m_movement_threshold;
+	CoalescingStats m_coalescing_stats;
+
+	// Event instances whose 3D attributes are pushed to FMOD at a distance based rate.
+	EmitterRegistry m_emitter_registry;
+
+	// Registered emitters of clustered events, played as one instance per cluster.
+	EmitterClusters m_emitter_clusters;
+
+	// Metered buses and dialogue lines.
+	LevelMeters m_level_meters;
+
+	// Event instances whose occlusion is queried from the game in batches.
+	OcclusionStage m_occlusion;
+
+	// Last attributes passed to "setListenerAttributes", used by the wrapper's own distance based logic.
+	FMOD_3D_ATTRIBUTES m_listeners[FMOD_MAX_LISTENERS];
+	float m_listener_weights[FMOD_MAX_LISTENERS];
+	int m_num_listeners;
+
+	// Listeners with a non-zero weight, gathered once per update for the distance based logic.
+	FMOD_3D_ATTRIBUTES m_active_listeners[FMOD_MAX_LISTENERS];
+	int m_num_active_listeners;
+
+	void gatherActiveListeners();
+
+	std::chrono::steady_clock::time_point m_last_update_time;
+	float m_delta_time;
+
+public:
+
+	friend class FmodWrapper;
+};
+
+class FmodWrapper
+{
+private:
+
+	static void initializeIdSystem();
+
+	// Keeps the last beat of the events used as references for "schedulePlayOnBeat".
+	static void trackReferenceBeat(const EventCallbackMessage& message, void* user_data);
+	static bool audio_engine_initialized;
+	
+	// To be used as a default argument for all "play sound" -functions when the caller does not provide any fmod parameters to set.  
+	static std::map<std::string, float> empty_map;
+
+public:
+
+	// Passing arguments by value vs. reference should be re-evaluated based on the call system implementation on the game engine side. 
+
+	static void initializeAudioEngine(const AudioEngineSettings& settings = AudioEngineSettings());
+
+	// Reads a startup bank list into "settings.startup_banks": one "<bank file>\t<metadata|samples>" pair per line, lines starting with '#' are skipped.
+	static int loadStartupManifest(const std::string& file_path, AudioEngineSettings& settings);
+	static const StartupTimingReport& getStartupTimingReport();
+	static void callUpdate();
+	static void shutDownAudioEngine();
+	static int errorCheck(FMOD_RESULT result);
+
+	// Capture every public call with its frame number into a binary log (see call_recorder.h for the replay side).
+	static int startCapture(const std::string& file_path);
+	static int stopCapture();
+
+	static WrapperDiagnostics getDiagnostics();
+
+	int loadBank(const std::string& bank, bool load_samples = true);
+	int unloadBank(const std::string& bank);
+	int loadSampleData(const std::string& bank);
+	int unloadSampleData(const std::string& bank);
+
+	// Hot reload of a rebuilt bank without blocking the game thread. The new file is read in the background while the old version keeps playing.
+	// FMOD can't hold two versions of a bank at once, so new plays of the bank are then queued until the old version's one-shots
+	// have ended (at most "drain_timeout" seconds), after which the versions are swapped and the queued plays start on the new one.
+	// Looping instances never end on their own and are stopped by the swap. The queued plays' wait is reported in the stats.
+	int reloadBank(const std::string& bank, float drain_timeout = 0.5f);
+	static bool isBankReloading(const std::string& bank);
+	static BankReloadStats getBankReloadStats();
+
+	// Voiceover localization -->
+
+	// Audio table bank of a locale, e.g. ("fr", ".../Voiceovers_FR.bank"). Locale banks are loaded and unloaded by "setVoiceoverLocale" only.
+	static int addVoiceoverLocale(const std::string& locale, const std::string& bank_file);
+
+	// Loads the locale's bank in the background. Dialogue keys keep resolving against the current locale until it has loaded,
+	// after which new lines use the new locale and the previous bank is unloaded. Lines already playing finish in the previous locale,
+	// their sounds are opened from the bank file and keep it open until they end. A locale bank already loaded from memory (pre-read)
+	// is refused for that reason. A new call while a switch is loading replaces its target.
+	int setVoiceoverLocale(const std::string& locale);
+	static std::string getVoiceoverLocale();
+	static VoiceoverLocaleStats getVoiceoverLocaleStats();
+
+	// Event to bank manifest and lazy bank loading -->
+
+	// Banks loaded through the wrapper are added to the manifest automatically. "buildBankManifest" loads the listed banks' metadata
+	// one by one to record their events (requires the strings bank) and writes the result to "output_path".
+	static int buildBankManifest(const std::vector<std::string>& bank_files, const std::string& output_path);
+	static int loadBankManifest(const std::string& file_path);
+	static int saveBankManifest(const std::string& file_path);
+
+	// When enabled, playing an event whose bank is in the manifest but not loaded starts a non-blocking load of the bank and returns an ID right away.
+	// The play is started once the bank is ready, or dropped after "timeout_seconds". The ID can be used with the other event functions meanwhile.
+	static void setLazyBankLoading(bool enabled, float timeout_seconds = 2.0f);
+	static LazyLoadStats getLazyLoadStats();
+
+	// Streaming world zones: the banks of a zone are loaded (metadata and sample data, non-blocking) when a listener approaches it,
+	// and their sample data is released when all listeners have moved away. Banks shared between zones stay loaded while any of the zones needs them.
+	unsigned long int addStreamingZone(const StreamingZone& zone);
+	int removeStreamingZone(unsigned long int zone_id);
+	static StreamingZoneStats getStreamingZoneStats();
+
+	unsigned long int play3DEvent(const std::string& event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters = empty_map);
+	unsigned long int play2DEvent(const std::string& event, std::map<std::string, float> parameters = empty_map);
+	int stopEvent(int event_id, bool allow_fades = true);
+
+	// Fire-and-forget variants for one-shots nobody needs to access afterwards. The instance is released right after starting,
+	// so no ID is returned and nothing is added to the wrapper's bookkeeping. Returns 1 if the event was started.
+	// Only events FMOD reports as one-shots are accepted, looping or sustaining events fail the call since they could never be stopped.
+	int playOneShot3D(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters = empty_map);
+	int playOneShot2D(const std::string& event, const std::map<std::string, float>& parameters = empty_map);
+	
+	int set3DAttributes(int event_id, FMOD_3D_ATTRIBUTES spatial_attributes);
+
+	// Puts a playing 3D event under distance based update LOD. Afterwards "set3DAttributes" only stores the attributes,
+	// and the wrapper sends them to FMOD every tick near a listener, less often further away and not at all if the emitter didn't move.
+	// For an event with clustering enabled, the instance is stopped instead and the ID becomes a member of the closest cluster
+	// of that event, pulling the cluster's centre towards it by "cluster_weight". "set3DAttributes" moves it, "stopEvent" and "unregisterEmitter" remove it.
+	int registerEmitter(int event_id, float cluster_weight = 1.0f);
+	int unregisterEmitter(int event_id);
+	static void setEmitterLodSettings(const EmitterLodSettings& settings);
+	static EmitterStats getEmitterStats();
+
+	// Emitter clustering for dense groups of the same looping event, e.g. crowds, rain on surfaces, torches. The event's registered emitters
+	// are grouped by distance every update and each cluster plays as one instance. Disabling (with the same event string) stops the clusters
+	// and drops their emitters. When the event's bank is unloaded or reloaded, the clusters stop and start again once the event is back.
+	static int enableEmitterClustering(const std::string& event, const EmitterClusterSettings& settings = EmitterClusterSettings());
+	static int disableEmitterClustering(const std::string& event);
+	static EmitterClusterStats getEmitterClusterStats();
+
+	// Occlusion of playing 3D events, queried through "setOcclusionQuery" in one batch per update within a ray budget.
+	// The smoothed result (0..1) is written to "parameter" by ID, or to the lowpass of the event when "parameter" is empty.
+	int enableOcclusion(int event_id, const std::string& parameter = "");
+	int disableOcclusion(int event_id);
+	static void setOcclusionQuery(OcclusionQueryCallback callback, void* user_data = nullptr);
+	static void setOcclusionSettings(const OcclusionSettings& settings);
+	static OcclusionStats getOcclusionStats();
+	static int setListenerAttributes(int listener_index, FMOD_3D_ATTRIBUTES spatial_attributes); 
+
+	// Multiple listeners, e.g. for split screen. Listener indices run from 0 to "num_listeners" - 1.
+	static int setNumberOfListeners(int num_listeners);
+	static int setListenerAttributesBatch(const ListenerTransformsSoA& transforms, int count, int first_listener = 0);
+
+	// Weight 0..1 of a listener's contribution to the mix, e.g. for cross-fading between cameras. Listeners with weight 0 are also ignored by the wrapper's distance based logic.
+	static int setListenerWeight(int listener_index, float weight);
+	
+	int setParameterByName(int event_id, std::string& parameter, float value);
+	int setGlobalParameterByName(std::string& parameter, float value);
+
+	// When enabled (the default), "set3DAttributes" and "setParameterByName" are staged per event and only the last value is sent to FMOD during the update.
+	// Parameter changes smaller than "parameter_epsilon" and moves shorter than "movement_threshold" are not sent at all.
+	// The handle and the parameter name are checked when staging, writes FMOD still rejects during the update are counted in the stats.
+	static void setUpdateCoalescing(bool enabled, float parameter_epsilon = 0.0f, float movement_threshold = 0.0f);
+	static CoalescingStats getCoalescingStats();
+
+	// These are commonly needed when implementing main and pause menu systems.
+	int setBusPauseStatus(const std::string& bus, bool is_paused);
+	int stopAllBusEvents(const std::string& bus, bool allow_fades);
+
+	// With a non-zero fade time the volume is ramped by the wrapper update, no per-frame calls are needed from the game.
+	int setBusVolume(const std::string& bus, float volume, float fade_seconds = 0.0f);
+	int setVCAVolume(const std::string& vca, float volume, float fade_seconds = 0.0f);
+
+	// Batched variants for e.g. pause menu transitions that touch many buses at once. Return 1 only if the operation succeeded for every bus / VCA.
+	int setBusPauseStatusBatch(const std::vector<std::string>& buses, bool is_paused);
+	int stopAllBusEventsBatch(const std::vector<std::string>& buses, bool allow_fades);
+	int setBusVolumeBatch(const std::vector<std::string>& buses, float volume, float fade_seconds = 0.0f);
+	int setVCAVolumeBatch(const std::vector<std::string>& vcas, float volume, float fade_seconds = 0.0f);
+
+	// Level metering, e.g. for VU meters and loudness based AI hearing. Returns a meter ID, which is also the "id" of the bus' reading.
+	// Dialogue lines are metered automatically under their event ID.
+	unsigned long int addBusMeter(const std::string& bus);
+	int removeMeter(unsigned long int meter_id);
+	static void setMeterSmoothing(float attack_seconds, float release_seconds);
+
+	// All readings of the last update as a flat array, valid until the next update.
+	static const MeterReading* getMeterReadings(int& count);
+	
+
+	// Mixer snapshots -->
+
+	// Requests of the same snapshot share a single instance, which is stopped when the last request is released.
+	// Returns a request ID for "setSnapshotIntensity" and "releaseSnapshot". Intensity is in percent, as in FMOD Studio.
+	unsigned long int activateSnapshot(const std::string& snapshot, float intensity = 100.0f, int priority = 0, float ramp_seconds = 0.0f);
+	int setSnapshotIntensity(unsigned long int request_id, float intensity, float ramp_seconds = 0.0f);
+	int releaseSnapshot(unsigned long int request_id, float ramp_seconds = 0.0f);
+
+	static bool isSnapshotActive(const std::string& snapshot);
+	// Paths of the active snapshots, highest priority first.
+	static const std::vector<std::string>& getActiveSnapshots();
+
+
+	// Sample accurate scheduling -->
+
+	// Times are in master DSP clock samples (see "getDSPClock"). Scheduled plays are issued "lookahead" seconds ahead of their time and
+	// held back by a start delay on the event's channel group, so they start on the requested sample rather than on the next update.
+	// An ID is returned right away. "stopEvent" cancels a play that hasn't been issued yet. Leave "spatial_attributes" null for 2D events.
+	unsigned long int schedulePlayAtClock(const std::string& event, unsigned long long dsp_clock, const FMOD_3D_ATTRIBUTES* spatial_attributes = nullptr, const std::map<std::string, float>& parameters = empty_map);
+
+	// "offset_seconds" after the start of a playing or scheduled event. Exact when the reference was itself scheduled, otherwise estimated from its timeline position.
+	unsigned long int schedulePlayAfterEvent(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes = nullptr, const std::map<std::string, float>& parameters = empty_map);
+
+	// On the first beat (or downbeat with "on_bar") of the reference event's timeline that is at least the lookahead away, plus "extra" beats (bars).
+	// Waits for the reference's next beat callback to learn its tempo and position.
+	unsigned long int schedulePlayOnBeat(const std::string& event, int reference_event_id, bool on_bar = false, int extra = 0, const FMOD_3D_ATTRIBUTES* spatial_attributes = nullptr, const std::map<std::string, float>& parameters = empty_map);
+
+	static unsigned long long getDSPClock();
+	static int getSampleRate();
+
+	// Has to cover the time between two updates plus the studio command latency. Defaults to 0.1 seconds.
+	static void setScheduleLookahead(float seconds);
+	static ScheduleStats getScheduleStats();
+
+
+	// Event callbacks -->
+
+	// FMOD fires event callbacks on its own thread. A subscriber gets them copied into a preallocated ring of "capacity" messages
+	// and its handler is called on the game thread during "callUpdate". Returns a subscriber ID.
+	static unsigned long int createCallbackSubscriber(EventCallbackHandler handler, void* user_data = nullptr, unsigned int capacity = 256);
+
+	// Stops the handler from being called. The subscriber's memory is kept until shutdown, since playing instances may still refer to it.
+	static int removeCallbackSubscriber(unsigned long int subscriber_id);
+	static unsigned long int getDroppedCallbacks(unsigned long int subscriber_id);
+
+	// "types" is a mask of e.g. FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_MARKER | FMOD_STUDIO_EVENT_CALLBACK_TIMELINE_BEAT.
+	// Subscribe right after playing the event (in the same frame) to also receive STARTED.
+	int subscribeEventCallbacks(unsigned long int subscriber_id, int event_id, FMOD_STUDIO_EVENT_CALLBACK_TYPE types);
+
+	static FMOD_RESULT F_CALLBACK eventCallbackRouter(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void* parameter);
+
+
+	// Audio state capture and restore, e.g. for save games and level restarts -->
+
+	// Serializes the playing event instances (GUID, timeline position, parameters, 3D attributes, pause state) and the paused buses into "blob".
+	// Dialogue lines are not included.
+	static int captureAudioState(std::vector<unsigned char>& blob);
+
+	// Queues the instances of "blob" to be started by the update, at most "instances_per_update" per update. The new IDs are returned
+	// as (saved ID, new ID) pairs in "id_map" and can be used right away. With "stop_current", everything playing is stopped first.
+	// The saved pause state is applied to all cached buses, so buses paused now but not in the blob are unpaused.
+	// Instances whose bank hasn't loaded within "bank_timeout" seconds are dropped and counted as failed.
+	int restoreAudioState(const std::vector<unsigned char>& blob, int instances_per_update = 32, bool stop_current = true,
+		std::vector<std::pair<unsigned long int, unsigned long int>>* id_map = nullptr, float bank_timeout = 10.0f);
+	static AudioStateStats getAudioStateStats();
+
+
+	// Programmer sound / audio table system for voiceovers -->
+
+	// Create an enum value for each programmer sound instrument you want to use in FMOD Studio for dialogue mixer routing and other speaker/situation specific processing.
+	enum DialogueMasterEvents
+	{
+		//For example...
+
+		PC,
+		NPC,
+		NPC_radio
+
+		//...etc.....	
+	};
+	
+	static FMOD_RESULT F_CALLBACK dialogueEventCallback(FMOD_STUDIO_EVENT_CALLBACK_TYPE type, FMOD_STUDIO_EVENTINSTANCE* event, void* parameter);
+
+	unsigned long int playDialogue3D(const std::string key, DialogueMasterEvents master_event, FMOD_3D_ATTRIBUTES spatial_attributes, std::map<std::string, float> parameters = empty_map);
+	unsigned long int playDialogue2D(const std::string key, DialogueMasterEvents master_event, std::map<std::string, float> parameters = empty_map);
+
+	// Smoothed level of a playing dialogue line for lip-sync. Returns 0 when the line is not playing.
+	static float getDialogueEnvelope(int event_id);
+
+	// Stream pool usage and compressed sample memory of the dialogue lines, see "AudioEngineSettings::dialogue_sounds".
+	static DialogueSoundStats getDialogueSoundStats();
+
+private:
+
+	// Bodies of the public functions that hand out an ID. The public ones record the call once the ID is known.
+	unsigned long int play3DEventInternal(const std::string& event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters);
+	unsigned long int play2DEventInternal(const std::string& event, const std::map<std::string, float>& parameters);
+	unsigned long int activateSnapshotInternal(const std::string& snapshot, float intensity, int priority, float ramp_seconds);
+	unsigned long int playDialogue3DInternal(const std::string& key, DialogueMasterEvents master_event, const FMOD_3D_ATTRIBUTES& spatial_attributes, const std::map<std::string, float>& parameters);
+	unsigned long int playDialogue2DInternal(const std::string& key, DialogueMasterEvents master_event, const std::map<std::string, float>& parameters);
+	unsigned long int schedulePlayAfterEventInternal(const std::string& event, int reference_event_id, double offset_seconds, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters);
+	unsigned long int schedulePlayOnBeatInternal(const std::string& event, int reference_event_id, bool on_bar, int extra, const FMOD_3D_ATTRIBUTES* spatial_attributes, const std::map<std::string, float>& parameters);
+	int restoreAudioStateInternal(const std::vector<unsigned char>& blob, int instances_per_update, bool stop_current, std::vector<std::pair<unsigned long int, unsigned long int>>* id_map, float bank_timeout);
+};
@@ -0,0 +1,86 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <stdint.h>
+
+// Flat C interface to the wrapper for scripting layers and engine bindings. Strings are registered once and then referred to by
+// their 32-bit FNV-1a hash, and per-frame work is submitted as an array of fixed size POD commands executed in a single call.
+
+#if defined(_WIN32) && defined(FW_BUILD_DLL)
+#define FW_API __declspec(dllexport)
+#else
+#define FW_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum FW_COMMAND_TYPE
+{
+	FW_CMD_PLAY_3D = 1,
+	FW_CMD_PLAY_2D,
+	FW_CMD_STOP,
+	FW_CMD_SET_3D_ATTRIBUTES,
+	FW_CMD_SET_PARAMETER,
+	FW_CMD_SET_GLOBAL_PARAMETER,
+	FW_CMD_SET_LISTENER_ATTRIBUTES,
+	FW_CMD_SET_BUS_PAUSED,
+	FW_CMD_STOP_BUS_EVENTS,
+	FW_CMD_SET_BUS_VOLUME,
+	FW_CMD_SET_VCA_VOLUME
+} FW_COMMAND_TYPE;
+
+// FW_CMD_STOP and FW_CMD_STOP_BUS_EVENTS: let the events fade out. FW_CMD_SET_BUS_PAUSED: pause instead of unpause.
+#define FW_FLAG_ENABLE 0x1
+
+// "handle" is the index of an earlier command in the same buffer, whose result is used as the event handle.
+// Lets a buffer play an event and set its parameters without a round trip. Needs a "results" array in "fw_execute".
+#define FW_FLAG_HANDLE_FROM_RESULT 0x2
+
+typedef struct FW_COMMAND
+{
+	uint32_t type;
+	uint32_t flags;
+
+	// Event path, bus / VCA path or global parameter name, as a registered name hash.
+	uint32_t name_hash;
+	// Local parameter name for FW_CMD_SET_PARAMETER.
+	uint32_t parameter_hash;
+
+	// Event handle returned by a play command, or the listener index.
+	uint64_t handle;
+
+	// Parameter value or volume.
+	float value;
+	float fade_seconds;
+
+	// 3D attributes for plays, FW_CMD_SET_3D_ATTRIBUTES and FW_CMD_SET_LISTENER_ATTRIBUTES.
+	float position[3];
+	float velocity[3];
+	float forward[3];
+	float up[3];
+} FW_COMMAND;
+
+FW_API void fw_initialize(int non_realtime_output, int num_listeners);
+FW_API void fw_update(void);
+FW_API void fw_shutdown(void);
+
+FW_API int fw_load_bank(const char* bank, int load_samples);
+FW_API int fw_unload_bank(const char* bank);
+
+// Returns the hash to use in commands, or 0 if another registered name already has the same hash.
+FW_API uint32_t fw_register_name(const char* name);
+
+// Plain 32-bit FNV-1a over the bytes of "name", so that bindings can also precompute the hashes.
+FW_API uint32_t fw_hash_name(const char* name);
+
+// Executes "count" commands in order. "results" (may be null) receives one value per command: the new event handle for plays,
+// otherwise 1 on success and 0 on failure. Returns the number of commands that succeeded.
+FW_API int fw_execute(const FW_COMMAND* commands, int count, uint64_t* results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "fmod.hpp"
+#include "fmod_studio.hpp"
+
+// Linear levels of one metered bus or event, combined over all channels.
+struct MeterReading
+{
+	unsigned long int id = 0;
+	float rms = 0.0f;
+	float peak = 0.0f;
+
+	// RMS smoothed with separate attack and release times, e.g. for lip-sync or VU meters.
+	float envelope = 0.0f;
+};
+
+// Collects DSP metering of buses and event instances once per update. The levels are kept as structure-of-arrays,
+// so that the RMS and envelope math runs over all meters at once (SSE where available), and then published as a flat reading array.
+
+class LevelMeters
+{
+public:
+
+	LevelMeters();
+
+	// The bus' channel group is locked while metered, so that it exists even when nothing is playing through the bus.
+	int addBus(unsigned long int id, FMOD::Studio::Bus* bus);
+	int addEvent(unsigned long int id, FMOD::Studio::EventInstance* instance);
+	int remove(unsigned long int id);
+	bool contains(unsigned long int id) const { return m_index.find(id) != m_index.end(); }
+	size_t size() const { return m_sources.size(); }
+
+	void update(float delta_time);
+
+	void setSmoothing(float attack_seconds, float release_seconds);
+	const MeterReading* getReadings(int& count) const;
+	const MeterReading* getReading(unsigned long int id) const;
+
+private:
+
+	struct Source
+	{
+		FMOD::Studio::Bus* bus;
+		FMOD::Studio::EventInstance* instance;
+		FMOD::DSP* dsp;
+	};
+
+	float m_attack_seconds;
+	float m_release_seconds;
+
+	std::vector<Source> m_sources;
+	std::unordered_map<unsigned long int, size_t> m_index;
+
+	// Per meter, same order as "m_sources".
+	std::vector<float> m_power;
+	std::vector<float> m_inverse_channels;
+	std::vector<float> m_rms;
+	std::vector<float> m_envelope;
+	std::vector<MeterReading> m_readings;
+
+	FMOD::DSP* resolveDSP(Source& source);
+	void computeLevels(float attack_coefficient, float release_coefficient);
+};
@@ -1,11 +1,11 @@
-MIT License
-Copyright (c) 2020 Ville Ojala
-
-#pragma once
-
-#include "fmod_wrapper.h"
-
-void printInfo(std::string message)
-{
-	std::cout << message << std::endl;
-}
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include "fmod_wrapper.h"
+
+void printInfo(std::string message)
+{
+	std::cout << message << std::endl;
+}
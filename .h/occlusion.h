@@ -0,0 +1,118 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "fmod.hpp"
+#include "fmod_studio.hpp"
+
+struct OcclusionRay
+{
+	unsigned long int emitter_id;
+	FMOD_VECTOR from;
+	FMOD_VECTOR to;
+};
+
+// Game side batch ray query. Fills "results" with the occlusion of each ray, 0 for a clear path and 1 for fully occluded.
+// Called from "callUpdate", so it must not call back into the wrapper.
+typedef void (*OcclusionQueryCallback)(const OcclusionRay* rays, int count, float* results, void* user_data);
+
+struct OcclusionSettings
+{
+	// Rays cast per update at most. Emitters are picked by how long they have waited, weighted towards near and loud ones.
+	int max_rays_per_update = 32;
+
+	// Emitters further than this from every listener are not queried and keep their last value.
+	float max_distance = 100.0f;
+
+	// An emitter is not queried again sooner than this.
+	float min_interval_seconds = 0.05f;
+
+	// Time constant of the smoothing between query results.
+	float smoothing_seconds = 0.15f;
+
+	// Lowpass gain at full occlusion, for emitters without an occlusion parameter.
+	float lowpass_min_gain = 0.25f;
+};
+
+struct OcclusionStats
+{
+	unsigned long int emitters = 0;
+	// Emitters that were due for a ray, and the rays actually cast.
+	unsigned long int candidates_last_update = 0;
+	unsigned long int rays_last_update = 0;
+	unsigned long long rays_total = 0;
+	// Time spent in the game's query callback.
+	double query_ms_last_update = 0.0;
+	double query_ms_max = 0.0;
+	// Average time the queried emitters had waited since their previous ray.
+	float average_wait_last_update = 0.0f;
+};
+
+// Runs the occlusion of registered event instances as one batched ray query per update. Results are smoothed and written
+// through a cached parameter ID, or through the lowpass of the event's channel group when no parameter is given.
+
+class OcclusionStage
+{
+public:
+
+	OcclusionStage();
+
+	// An empty "parameter" uses the lowpass instead.
+	int add(unsigned long int id, FMOD::Studio::EventInstance* instance, const std::string& parameter);
+	int remove(unsigned long int id);
+	bool contains(unsigned long int id) const { return m_index.find(id) != m_index.end(); }
+
+	void setPosition(unsigned long int id, const FMOD_VECTOR& position);
+	void setQuery(OcclusionQueryCallback callback, void* user_data);
+	void setSettings(const OcclusionSettings& settings) { m_settings = settings; }
+
+	void update(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners, float delta_time);
+
+	// Smoothed occlusion of an emitter, or -1 if it is not registered.
+	float getOcclusion(unsigned long int id) const;
+	const OcclusionStats& getStats() const { return m_stats; }
+
+private:
+
+	struct Emitter
+	{
+		unsigned long int id;
+		FMOD::Studio::EventInstance* instance;
+		bool use_parameter;
+		FMOD_STUDIO_PARAMETER_ID parameter_id;
+		FMOD_VECTOR position;
+		float target;
+		float smoothed;
+		float applied;
+		float wait;
+	};
+
+	struct Candidate
+	{
+		size_t index;
+		int listener;
+		float score;
+	};
+
+	OcclusionSettings m_settings;
+	OcclusionStats m_stats;
+	OcclusionQueryCallback m_callback;
+	void* m_callback_user_data;
+
+	std::vector<Emitter> m_emitters;
+	std::unordered_map<unsigned long int, size_t> m_index;
+
+	// Reused between updates, so that a steady state update doesn't allocate.
+	std::vector<Candidate> m_candidates;
+	std::vector<OcclusionRay> m_rays;
+	std::vector<float> m_results;
+
+	void gatherCandidates(const FMOD_3D_ATTRIBUTES* listeners, int num_listeners);
+	void query();
+	void apply(Emitter& emitter);
+};
@@ -0,0 +1,67 @@
+MIT License
+Copyright (c) 2020 Ville Ojala
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Fixed capacity single-producer / single-consumer ring buffer. The storage is allocated up front,
+// so "push" never allocates or locks and is safe to call from FMOD's threads while the game thread calls "pop".
+
+template <typename T>
+class SpscRing
+{
+public:
+
+	explicit SpscRing(size_t capacity)
+	{
+		// Round up to a power of two so that wrapping around is a mask instead of a division.
+		size_t size = 1;
+		while (size < capacity) { size <<= 1; }
+
+		m_buffer.resize(size);
+		m_mask = size - 1;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	// Producer side. Returns false if the ring is full, in which case the item is dropped.
+	bool push(const T& item)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		size_t tail = m_tail.load(std::memory_order_acquire);
+		if (head - tail > m_mask) { return false; }
+
+		m_buffer[head & m_mask] = item;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns false if the ring is empty.
+	bool pop(T& item)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t head = m_head.load(std::memory_order_acquire);
+		if (tail == head) { return false; }
+
+		item = m_buffer[tail & m_mask];
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	size_t capacity() const { return m_mask + 1; }
+
+private:
+
+	std::vector<T> m_buffer;
+	size_t m_mask;
+
+	// Kept on separate cache lines, the producer and the consumer each write only one of them.
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+};